@@ -635,7 +635,11 @@ void BatchContext::importFiles(sg::NodePtr world)
             importer->setInstanceConfiguration(
                 sg::InstanceConfiguration::ROBUST);
 
-          importer->importScene();
+          {
+            // defer parent notification until the whole asset is imported
+            sg::ModificationTransaction transaction;
+            importer->importScene();
+          }
         }
       }
     } catch (const std::exception &e) {
@@ -10,6 +10,7 @@
 #include <stdexcept>
 // ospray_sg
 #include "sg/Math.h"
+#include "sg/SearchIndex.h"
 #include "sg/camera/Camera.h"
 #include "sg/fb/FrameBuffer.h"
 #include "sg/generator/Generator.h"
@@ -39,6 +40,8 @@ GUIContext::GUIContext(StudioCommon &_common)
     : StudioContext(_common, StudioMode::GUI)
 {
   pluginManager = std::make_shared<PluginManager>();
+  // keeps the search widgets quick on large scenes
+  sg::SearchIndex::enable(*frame);
   optSPP = 1; // Default SamplesPerPixel in interactive mode is one.
   if (frame->hasChild("framebuffer"))
     framebuffer = frame->child("framebuffer").nodeAs<FrameBuffer>();
@@ -50,6 +53,8 @@ GUIContext::GUIContext(StudioCommon &_common)
 
 GUIContext::~GUIContext()
 {
+  // the index keeps a plain pointer to its root, which goes with the frame
+  sg::SearchIndex::disable();
   pluginManager->removeAllPlugins();
   g_sceneCameras.clear();
   clearAssets();
@@ -317,6 +322,13 @@ void GUIContext::addToCommandLine(std::shared_ptr<CLI::App> app) {
     optSaveImageOnGUIExit,
     "Save final image when exiting GUI mode"
   );
+  app->add_option_function<float>(
+    "--target-frame-time",
+    [&](const float &ms) {
+      frame->child("dynamicResolution")["targetFrameTime"] = ms;
+    },
+    "Adapt the navigation resolution to render frames in this many ms (0 disables)"
+  )->check(CLI::NonNegativeNumber);
 }
 
 bool GUIContext::parseCommandLine()
@@ -397,6 +409,9 @@ void GUIContext::importFiles(NodePtr world)
           importer->setLightsManager(lightsManager);
           importer->setArguments(studioCommon.argc, (char **)studioCommon.argv);
           importer->setScheduler(scheduler);
+          if (!importCancellation)
+            importCancellation = sg::CancellationToken::create();
+          importer->setCancellationToken(importCancellation);
           importer->setAnimationList(animationManager->getAnimations());
           if (optInstanceConfig == "dynamic")
             importer->setInstanceConfiguration(
@@ -408,7 +423,11 @@ void GUIContext::importFiles(NodePtr world)
             importer->setInstanceConfiguration(
                 InstanceConfiguration::ROBUST);
 
-          importer->importScene();
+          {
+            // defer parent notification until the whole asset is imported
+            sg::ModificationTransaction transaction;
+            importer->importScene();
+          }
         }
       }
     } catch (const std::exception &e) {
@@ -484,18 +503,69 @@ void GUIContext::printUtilNode(const std::string &utilNode)
 
 bool GUIContext::resHasHit(float &x, float &y, vec3f &worldPosition)
 {
+  // Nothing to cast a ray at if the last finished frame had nothing there,
+  // the pick buffer isn't valid once its copy is older than that frame
+  PickBuffer::Hit hit;
+  if (pickBuffer.valid() && !pickBuffer.pick(vec2f(x, y), hit))
+    return false;
+
   ospray::cpp::PickResult res;
   auto &fb = frame->childAs<FrameBuffer>("framebuffer");
   auto &r = frame->childAs<Renderer>("renderer");
   auto &c = frame->childAs<Camera>("camera");
   auto &w = frame->childAs<World>("world");
-  res = fb.handle().pick(r, c, w, x, y);
+
+  // While a region of interest renders, the camera and the framebuffer only
+  // cover the region, the click has to be placed in it
+  vec2f pos(x, y);
+  const auto roiStart = c["roiStart"].valueAs<vec2f>();
+  const auto roiEnd = c["roiEnd"].valueAs<vec2f>();
+  if (roiStart != vec2f(0.f) || roiEnd != vec2f(1.f)) {
+    pos = (pos - roiStart) / (roiEnd - roiStart);
+    if (pos.x < 0.f || pos.x > 1.f || pos.y < 0.f || pos.y > 1.f)
+      return false;
+  }
+
+  res = fb.handle().pick(r, c, w, pos.x, pos.y);
   worldPosition = res.worldPosition;
   if (res.hasHit)
     c["lookAt"] = vec3f(worldPosition);
   return res.hasHit;
 }
 
+// The most specific node of a hit, the geometry's transform if it has an id
+static NodePtr nodeOfHit(World &world, const PickBuffer::Hit &hit)
+{
+  auto node = world.geometryNodes.get(hit.objectId);
+  return node ? node : world.instanceNodes.get(hit.instanceId);
+}
+
+NodePtr GUIContext::pickNode(const vec2f &pos)
+{
+  PickBuffer::Hit hit;
+  if (!pickBuffer.pick(pos, hit))
+    return nullptr;
+  return nodeOfHit(frame->childAs<World>("world"), hit);
+}
+
+std::vector<std::vector<NodePtr>> GUIContext::pickNodes(
+    const std::vector<box2f> &regions)
+{
+  auto &world = frame->childAs<World>("world");
+  std::vector<std::vector<NodePtr>> nodes(regions.size());
+  auto hits = pickBuffer.pick(regions);
+  for (size_t r = 0; r < hits.size(); ++r) {
+    for (const auto &hit : hits[r]) {
+      auto node = nodeOfHit(world, hit);
+      if (node
+          && std::find(nodes[r].begin(), nodes[r].end(), node)
+              == nodes[r].end())
+        nodes[r].push_back(node);
+    }
+  }
+  return nodes;
+}
+
 void GUIContext::getWindowTitle(std::stringstream &windowTitle)
 {
   windowTitle << "OSPRay Studio: ";
@@ -707,6 +777,13 @@ void GUIContext::createIsoSurface(
 
 void GUIContext::clearScene()
 {
+  // Drop the import tasks which didn't run yet, instead of adding their
+  // nodes to the cleared scene
+  if (importCancellation) {
+    importCancellation->cancel();
+    importCancellation = nullptr;
+  }
+
   // Cancel any in-progress frame
   frame->cancelFrame();
   frame->waitOnFrame();
@@ -10,6 +10,7 @@
 #include "ospStudio.h"
 // ospray sg
 #include "sg/Frame.h"
+#include "sg/fb/PickBuffer.h"
 // ospray widgets
 #include "PluginManager.h"
 #include "widgets/Panel.h"
@@ -49,6 +50,12 @@ class GUIContext : public StudioContext
   void changeToDefaultCamera();
   void printUtilNode(const std::string &utilNode);
   bool resHasHit(float &x, float &y, vec3f &worldPosition);
+  // Nodes hit in the last finished frame at normalized position 'pos', or
+  // in each of 'regions', null/empty without ID buffers
+  sg::NodePtr pickNode(const vec2f &pos);
+  std::vector<std::vector<sg::NodePtr>> pickNodes(
+      const std::vector<box2f> &regions);
+  sg::PickBuffer pickBuffer;
   void getWindowTitle(std::stringstream &windowTitle);
   vec2i &getFBSize();
   void updateFovy(const float &sensitivity, const float &scrollY);
@@ -93,4 +100,8 @@ class GUIContext : public StudioContext
   std::string scene;
   
   float lockAspectRatio = 0.0;
+
+ private:
+  // Shared by the imports since the scene was last cleared
+  sg::CancellationTokenPtr importCancellation{nullptr};
 };
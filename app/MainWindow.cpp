@@ -307,12 +307,14 @@ void MainWindow::initGLFW()
   glEnable(GL_TEXTURE_2D);
   glDisable(GL_LIGHTING);
 
-  // create OpenGL frame buffer texture
-  glGenTextures(1, &framebufferTexture);
+  // create OpenGL frame buffer textures
   glEnable(GL_TEXTURE_2D);
-  glBindTexture(GL_TEXTURE_2D, framebufferTexture);
-  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+  for (auto *texture : {&frameTexture, &roiTexture}) {
+    glGenTextures(1, &texture->id);
+    glBindTexture(GL_TEXTURE_2D, texture->id);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+  }
 
   ctx->refreshScene(true);
 
@@ -633,7 +635,13 @@ void MainWindow::display()
   fbSize = ctx->getFBSize();
 
   if (ctx->frame->frameIsReady()) {
-    if (!ctx->frame->isCanceled()) {
+    const bool displayFrame = !ctx->frame->isCanceled();
+
+    // the scene changed since the last frame picking could answer from
+    if (!displayFrame)
+      ctx->pickBuffer.clear();
+
+    if (displayFrame) {
       // display frame rate in window title
       auto displayEnd = std::chrono::high_resolution_clock::now();
       auto durationMilliseconds =
@@ -642,104 +650,16 @@ void MainWindow::display()
 
       latestFPS = 1000.f / float(durationMilliseconds.count());
 
-      // map OSPRay framebuffer, update OpenGL texture with contents, then unmap
       waitOnOSPRayFrame();
 
-      bool displayBufferColor = ctx->optDisplayBuffer & OSP_FB_COLOR;
-      bool displayBufferDepth = ctx->optDisplayBuffer & OSP_FB_DEPTH;
-      bool displayBufferAccum = ctx->optDisplayBuffer & OSP_FB_ACCUM;
-      bool displayBufferVariance = ctx->optDisplayBuffer & OSP_FB_VARIANCE;
-      bool displayBufferNormal = ctx->optDisplayBuffer & OSP_FB_NORMAL;
-      bool displayBufferAlbedo = ctx->optDisplayBuffer & OSP_FB_ALBEDO;
-      bool displayBufferPrimitive = ctx->optDisplayBuffer & OSP_FB_ID_PRIMITIVE;
-      bool displayBufferObject = ctx->optDisplayBuffer & OSP_FB_ID_OBJECT;
-      bool displayBufferInstance = ctx->optDisplayBuffer & OSP_FB_ID_INSTANCE;
-
-      // optDisplayBufferInvert is separate
-      auto *mappedFB = (void *)ctx->frame->mapFrame(
+      // copy the displayed channel out of the OSPRay framebuffer, which is
+      // free to render the next frame then
+      const auto &front = ctx->frame->swapBuffers(
           OSPFrameBufferChannel(ctx->optDisplayBuffer));
 
-      // Only create the copy if it's needed
-      std::vector<float> bufferCopy;
-      if (ctx->optDisplayBufferInvert
-          && (displayBufferColor || displayBufferAlbedo
-              || displayBufferNormal)) {
-        // Create a local copy and don't modify OSPRay buffer
-        const auto *mappedColor = static_cast<const float *>(mappedFB);
-        const auto num = displayBufferColor ? 4 : 3;
-        std::vector<float> colorCopy(
-            mappedColor, mappedColor + fbSize.x * fbSize.y * num);
-        bufferCopy = std::move(colorCopy);
-
-      } else if (displayBufferPrimitive
-          || displayBufferObject || displayBufferInstance) {
-        const auto *mappedID = static_cast<const uint32_t *>(mappedFB);
-        std::vector<float> colorsID(fbSize.x * fbSize.y * 3);
-
-        tasking::parallel_for(fbSize.x * fbSize.y, [&](int px) {
-          const vec4f color = ospray::sg::makeRandomColor(mappedID[px]);
-          colorsID[px * 3 + 0] = color.x;
-          colorsID[px * 3 + 1] = color.y;
-          colorsID[px * 3 + 2] = color.z;
-        });
-
-        bufferCopy = std::move(colorsID);
-
-      } else if (displayBufferDepth) {
-        // Create a local copy and don't modify OSPRay buffer
-        const auto *mappedDepth = static_cast<const float *>(mappedFB);
-        std::vector<float> depthCopy(
-            mappedDepth, mappedDepth + fbSize.x * fbSize.y);
-
-        // Scale OSPRay's 0 -> inf depth range to OpenGL 0 -> 1, ignoring all
-        // inf values
-        float minValue = rkcommon::math::inf;
-        float maxValue = rkcommon::math::neg_inf;
-        for (auto value : depthCopy) {
-          if (isinf(value))
-            continue;
-          minValue = std::min(minValue, value);
-          maxValue = std::max(maxValue, value);
-        }
-
-        const float rcpRange = 1.f / (maxValue - minValue);
-        std::transform(depthCopy.begin(),
-            depthCopy.end(),
-            depthCopy.begin(),
-            [&](float value) {
-              return isinf(value) ? 1.f : (value - minValue) * rcpRange;
-            });
-
-        bufferCopy = std::move(depthCopy);
-      }
-
-      if (!bufferCopy.empty()) {
-        // Inverted values (1.0 -> 0.0) may be more meaningful
-        if (ctx->optDisplayBufferInvert)
-          std::transform(bufferCopy.begin(),
-              bufferCopy.end(),
-              bufferCopy.begin(),
-              [&](float value) { return (1.f - value); });
-      }
-
-      GLenum glType = GL_FLOAT;
-      if (displayBufferColor && !ctx->framebuffer->isFloatFormat())
-        glType = GL_UNSIGNED_BYTE;
-
-      glBindTexture(GL_TEXTURE_2D, framebufferTexture);
-      glTexImage2D(GL_TEXTURE_2D,
-          0,
-          displayBufferColor ? gl_rgba_format : gl_rgb_format,
-          fbSize.x,
-          fbSize.y,
-          0,
-          displayBufferColor       ? GL_RGBA
-              : displayBufferDepth ? GL_LUMINANCE
-                                   : GL_RGB,
-          glType,
-          !bufferCopy.empty() ? bufferCopy.data() : mappedFB);
-
-      ctx->frame->unmapFrame(mappedFB);
+      // the ID buffers of the finished frame answer picking until the next
+      ctx->pickBuffer.update(
+          ctx->frame->childAs<sg::FrameBuffer>("framebuffer"), front.region);
 
       // save frame to a file, if requested
       if (g_saveNextFrame) {
@@ -751,6 +671,10 @@ void MainWindow::display()
     // Start new frame and reset frame timing interval start
     displayStart = std::chrono::high_resolution_clock::now();
     startNewOSPRayFrame();
+
+    // the finished frame is processed and uploaded while the next one renders
+    if (displayFrame)
+      uploadFrontBuffer(ctx->frame->frontBuffer());
   }
 
   // Allow OpenGL to show linear buffers as sRGB.
@@ -778,6 +702,7 @@ void MainWindow::display()
 
   // render textured quad with OSPRay frame buffer contents
   border *= 0.5f;
+  glBindTexture(GL_TEXTURE_2D, frameTexture.id);
   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_BORDER);
   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_BORDER);
 
@@ -797,6 +722,36 @@ void MainWindow::display()
 
   glEnd();
 
+  // the region of interest covers its part of the full frame, in window
+  // coordinates of the texture coordinates above
+  if (showRoi) {
+    auto toWindow = [&](const vec2f &uv) {
+      return (uv - border) / (vec2f(1.f) - 2.f * border) * vec2f(windowSize);
+    };
+    const vec2f lower = toWindow(roiRegion.lower);
+    const vec2f upper = toWindow(roiRegion.upper);
+
+    glBindTexture(GL_TEXTURE_2D, roiTexture.id);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+    glBegin(GL_QUADS);
+
+    glTexCoord2f(0.f, 0.f);
+    glVertex2f(lower.x, lower.y);
+
+    glTexCoord2f(0.f, 1.f);
+    glVertex2f(lower.x, upper.y);
+
+    glTexCoord2f(1.f, 1.f);
+    glVertex2f(upper.x, upper.y);
+
+    glTexCoord2f(1.f, 0.f);
+    glVertex2f(upper.x, lower.y);
+
+    glEnd();
+  }
+
   glDisable(GL_FRAMEBUFFER_SRGB);
 
   if (showUi) {
@@ -826,6 +781,171 @@ void MainWindow::display()
   glfwSwapBuffers(glfwWindow);
 }
 
+// Values per task of the display kernels, plain loops over a block which the
+// compiler can vectorize
+static constexpr size_t displayBlockSize = 64 * 1024;
+
+// Runs 'kernel(begin, end)' on the blocks of [0, count) in parallel
+template <typename KERNEL_T>
+static void forEachBlock(size_t count, KERNEL_T &&kernel)
+{
+  const size_t numBlocks = (count + displayBlockSize - 1) / displayBlockSize;
+  tasking::parallel_for(numBlocks, [&](size_t block) {
+    const size_t begin = block * displayBlockSize;
+    kernel(begin, std::min(begin + displayBlockSize, count));
+  });
+}
+
+// Range of the finite values in 'depth', reduced from blocks
+static range1f finiteDepthRange(const float *depth, size_t numPixels)
+{
+  const size_t numBlocks = (numPixels + displayBlockSize - 1) / displayBlockSize;
+  std::vector<range1f> blockRanges(numBlocks);
+
+  forEachBlock(numPixels, [&](size_t begin, size_t end) {
+    float lower = rkcommon::math::inf;
+    float upper = rkcommon::math::neg_inf;
+    for (size_t i = begin; i < end; ++i) {
+      const float value = depth[i];
+      const bool finite = value < rkcommon::math::inf;
+      lower = finite && value < lower ? value : lower;
+      upper = finite && value > upper ? value : upper;
+    }
+    blockRanges[begin / displayBlockSize] = range1f(lower, upper);
+  });
+
+  range1f range(rkcommon::math::empty);
+  for (const auto &r : blockRanges)
+    range.extend(r);
+  return range;
+}
+
+void MainWindow::uploadFrontBuffer(const sg::Frame::FrontBuffer &front)
+{
+  const vec2i size = front.size;
+  const size_t numPixels = size_t(size.x) * size.y;
+  const bool invert = ctx->optDisplayBufferInvert;
+
+  bool displayBufferColor = front.channel & OSP_FB_COLOR;
+  bool displayBufferDepth = front.channel & OSP_FB_DEPTH;
+  bool displayBufferNormal = front.channel & OSP_FB_NORMAL;
+  bool displayBufferAlbedo = front.channel & OSP_FB_ALBEDO;
+  bool displayBufferPrimitive = front.channel & OSP_FB_ID_PRIMITIVE;
+  bool displayBufferObject = front.channel & OSP_FB_ID_OBJECT;
+  bool displayBufferInstance = front.channel & OSP_FB_ID_INSTANCE;
+
+  const GLenum internalFormat =
+      displayBufferColor ? gl_rgba_format : gl_rgb_format;
+  const GLenum format = displayBufferColor ? GL_RGBA
+      : displayBufferDepth                 ? GL_LUMINANCE
+                                           : GL_RGB;
+  GLenum type = GL_FLOAT;
+  if (displayBufferColor && !front.floatFormat)
+    type = GL_UNSIGNED_BYTE;
+  // displayed as is, unless post-processed into the staging buffer below
+  const void *pixels = front.data.data();
+
+  // Inverted values (1.0 -> 0.0) may be more meaningful
+  if (invert
+      && (displayBufferColor || displayBufferAlbedo || displayBufferNormal)) {
+    const size_t numValues = numPixels * (displayBufferColor ? 4 : 3);
+    displayStaging.resize(numValues);
+    float *dst = displayStaging.data();
+    pixels = dst;
+
+    if (type == GL_UNSIGNED_BYTE) {
+      // 8 bit color is inverted to float
+      const auto *src = front.as<uint8_t>();
+      forEachBlock(numValues, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i)
+          dst[i] = 1.f - src[i] * (1.f / 255.f);
+      });
+      type = GL_FLOAT;
+    } else {
+      const auto *src = front.as<float>();
+      forEachBlock(numValues, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i)
+          dst[i] = 1.f - src[i];
+      });
+    }
+
+  } else if (displayBufferPrimitive || displayBufferObject
+      || displayBufferInstance) {
+    const auto *ids = front.as<uint32_t>();
+    displayStaging.resize(numPixels * 3);
+    float *dst = displayStaging.data();
+    pixels = dst;
+
+    forEachBlock(numPixels, [&](size_t begin, size_t end) {
+      for (size_t px = begin; px < end; ++px) {
+        const vec4f color = ospray::sg::makeRandomColor(ids[px]);
+        dst[px * 3 + 0] = invert ? 1.f - color.x : color.x;
+        dst[px * 3 + 1] = invert ? 1.f - color.y : color.y;
+        dst[px * 3 + 2] = invert ? 1.f - color.z : color.z;
+      }
+    });
+
+  } else if (displayBufferDepth) {
+    const auto *depth = front.as<float>();
+    displayStaging.resize(numPixels);
+    float *dst = displayStaging.data();
+    pixels = dst;
+
+    // Scale OSPRay's 0 -> inf depth range to OpenGL 0 -> 1, ignoring all inf
+    // values, which map to 1
+    const range1f range = finiteDepthRange(depth, numPixels);
+    const float rcpRange = 1.f / (range.upper - range.lower);
+    // invert: 1 - (d - lower) * rcpRange
+    const float scale = invert ? -rcpRange : rcpRange;
+    const float offset = invert ? 1.f + range.lower * rcpRange
+                                : -range.lower * rcpRange;
+    const float infValue = invert ? 0.f : 1.f;
+
+    forEachBlock(numPixels, [&](size_t begin, size_t end) {
+      for (size_t i = begin; i < end; ++i) {
+        const float value = depth[i];
+        dst[i] = value < rkcommon::math::inf ? value * scale + offset
+                                             : infValue;
+      }
+    });
+  }
+
+  // A region of interest is shown over the last full frame
+  auto &texture = front.regionOfInterest ? roiTexture : frameTexture;
+  roiRegion = front.region;
+  showRoi = front.regionOfInterest;
+
+  uploadTexture(texture, size, internalFormat, format, type, pixels);
+}
+
+void MainWindow::uploadTexture(DisplayTexture &texture,
+    const vec2i &size,
+    GLenum internalFormat,
+    GLenum format,
+    GLenum type,
+    const void *pixels)
+{
+  glBindTexture(GL_TEXTURE_2D, texture.id);
+
+  // Only reallocate the texture when its size or format changes
+  if (size == texture.size && internalFormat == texture.internalFormat) {
+    glTexSubImage2D(
+        GL_TEXTURE_2D, 0, 0, 0, size.x, size.y, format, type, pixels);
+  } else {
+    glTexImage2D(GL_TEXTURE_2D,
+        0,
+        internalFormat,
+        size.x,
+        size.y,
+        0,
+        format,
+        type,
+        pixels);
+    texture.size = size;
+    texture.internalFormat = internalFormat;
+  }
+}
+
 void MainWindow::startNewOSPRayFrame()
 {
   ctx->frame->startNewFrame();
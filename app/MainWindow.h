@@ -65,14 +65,39 @@ class MainWindow
   
   void pickCenterOfRotation(float x, float y);
 
+  // OpenGL texture, updated in place while its size and format don't change
+  struct DisplayTexture
+  {
+    GLuint id{0};
+    vec2i size{0};
+    GLenum internalFormat{0};
+  };
+
+  // Post-processes the frame's front buffer as needed to display it, and
+  // uploads it to the texture of a full frame or of a region of interest
+  void uploadFrontBuffer(const sg::Frame::FrontBuffer &front);
+  void uploadTexture(DisplayTexture &texture,
+      const vec2i &size,
+      GLenum internalFormat,
+      GLenum format,
+      GLenum type,
+      const void *pixels);
+
     // GLFW window instance
   GLFWwindow *glfwWindow = nullptr;
 
   std::shared_ptr<MainMenuBuilder> mainMenuBuilder = nullptr;
   std::shared_ptr<WindowsBuilder> windowsBuilder = nullptr;
 
-  // OpenGL framebuffer texture
-  GLuint framebufferTexture = 0;
+  // OpenGL textures of the last full frame, and of the region of interest
+  // rendered since which is shown over it
+  DisplayTexture frameTexture;
+  DisplayTexture roiTexture;
+  box2f roiRegion{vec2f(0.f), vec2f(1.f)};
+  bool showRoi{false};
+
+  // post-processed display channels, kept across frames
+  std::vector<float> displayStaging;
 
   // optional registered display callback, called before every display()
   std::function<void(MainWindow *)> displayCallback;
@@ -411,6 +411,48 @@ void WindowsBuilder::buildWindowFrameBufferEditor()
         ctx->frame->child("scaleNav") = newScale;
       ImGui::EndCombo();
     }
+
+    auto &dr = ctx->frame->child("dynamicResolution");
+    auto targetFrameTime = dr["targetFrameTime"].valueAs<float>();
+    ImGui::SetNextItemWidth(5 * ImGui::GetFontSize());
+    if (ImGui::DragFloat("Nav target frame time",
+            &targetFrameTime, 1.f, 0.f, 1000.f, "%.0f ms"))
+      dr["targetFrameTime"] = std::max(targetFrameTime, 0.f);
+    sg::showTooltip("Scale nav resolution to render in this time, 0 disables");
+
+    if (targetFrameTime > 0.f) {
+      auto adjustPixelSamples = dr["adjustPixelSamples"].valueAs<bool>();
+      if (ImGui::Checkbox("Adjust nav pixel samples", &adjustPixelSamples))
+        dr["adjustPixelSamples"] = adjustPixelSamples;
+      sg::showTooltip("Trade pixel samples once the scale is at its limits");
+
+      ImGui::Text("nav frame time %.1f ms", dr["frameTime"].valueAs<float>());
+      if (dr["pixelSamples"].valueAs<int>() > 0) {
+        ImGui::SameLine();
+        ImGui::Text("at %d spp", dr["pixelSamples"].valueAs<int>());
+      }
+    }
+  }
+
+  ImGui::Separator();
+
+  auto &roi = ctx->frame->child("roi");
+  auto roiEnabled = roi["enabled"].valueAs<bool>();
+  if (ImGui::Checkbox("Region of interest", &roiEnabled))
+    roi["enabled"] = roiEnabled;
+  sg::showTooltip(
+      "Render only this part of the image, over the last full frame");
+
+  if (roiEnabled) {
+    auto roiStart = roi["start"].valueAs<vec2f>();
+    auto roiEnd = roi["end"].valueAs<vec2f>();
+    ImGui::SetNextItemWidth(10 * ImGui::GetFontSize());
+    if (ImGui::SliderFloat2("start", roiStart, 0.f, 1.f))
+      roi["start"] = roiStart;
+    ImGui::SetNextItemWidth(10 * ImGui::GetFontSize());
+    if (ImGui::SliderFloat2("end", roiEnd, 0.f, 1.f))
+      roi["end"] = roiEnd;
+    sg::showTooltip("Normalized image coordinates, (0, 0) is the lower left");
   }
 
   ImGui::Separator();
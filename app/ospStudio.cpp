@@ -235,6 +235,21 @@ void StudioContext::addToCommandLine(std::shared_ptr<CLI::App> app)
     optDoAsyncTasking,
     "Enable/Disable asynchronous tasking (and asynchronous dataset loading)"
   );
+  app->add_option_function<size_t>(
+    "--async-tasks",
+    [&](const size_t &numThreads) {
+      scheduler->setConcurrency(numThreads);
+    },
+    "Set the number of asynchronous tasks running concurrently (default: number of hardware threads)"
+  )->check(CLI::PositiveNumber);
+  app->add_option_function<std::string>(
+    "--scheduler-trace",
+    [&](const std::string &fileName) {
+      optSchedulerTrace = fileName;
+      sg::scheduler::Trace::enable();
+    },
+    "Trace scheduler tasks and write them to a Chrome trace event JSON file on exit"
+  );
   app->add_flag(
     "--denoiser",
     optDenoiser,
@@ -425,6 +440,12 @@ int main(int argc, const char *argv[])
     else
       std::cerr << "Could not create a valid context. Stopping." << std::endl;
 
+    if (context && !context->optSchedulerTrace.empty()) {
+      if (!sg::scheduler::Trace::writeChromeJson(context->optSchedulerTrace))
+        std::cerr << "Failed to write scheduler trace '"
+                  << context->optSchedulerTrace << "'" << std::endl;
+    }
+
   }
 #if defined(EXCEPTION_GUARD)
  catch (const std::exception &e) {
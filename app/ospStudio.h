@@ -13,6 +13,7 @@
 // ospray sg
 #include "sg/Frame.h"
 #include "sg/Scheduler.h"
+#include "sg/SchedulerTrace.h"
 #include "sg/renderer/MaterialRegistry.h"
 #include "sg/scene/lights/LightsManager.h"
 #include "sg/Mpi.h"
@@ -182,6 +183,7 @@ class StudioContext : public std::enable_shared_from_this<StudioContext>
   std::string optSceneConfig{""};
   std::string optInstanceConfig{""};
   bool optDoAsyncTasking{false};
+  std::string optSchedulerTrace{""};
   float maxContribution{math::inf};
   int frameAccumLimit{0};
   std::string optImageName{"studio"}; // (each mode sets this default)
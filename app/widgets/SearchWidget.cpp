@@ -37,9 +37,17 @@ void SearchWidget::search(NR root)
   searchResults.clear();
 
   // Search the entire hierarchy of passed-in root node for nodes of specific
-  // searchTypes and name containing searchStr
-  for (auto nt : searchTypes)
-    root.traverse<ospray::sg::Search>(searchStr, nt, searchResults);
+  // searchTypes and name containing searchStr, through the index if it's
+  // maintained for that hierarchy
+  using ospray::sg::SearchIndex;
+  const bool indexed = SearchIndex::covers(root);
+  for (auto nt : searchTypes) {
+    if (indexed) {
+      auto found = SearchIndex::find(root, searchStr, nt);
+      searchResults.insert(searchResults.end(), found.begin(), found.end());
+    } else
+      root.traverseParallel<ospray::sg::Search>(searchStr, nt, searchResults);
+  }
 }
 
 void SearchWidget::addSearchBarUI(NR root)
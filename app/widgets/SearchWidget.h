@@ -5,6 +5,7 @@
 
 #include "sg/Node.h"
 #include "sg/NodeType.h"
+#include "sg/SearchIndex.h"
 #include "sg/visitors/Search.h"
 
 #include "GenerateImGuiWidgets.h" // TreeState
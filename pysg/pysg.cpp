@@ -79,6 +79,22 @@ void assignMPI(int rank, int size)
   sgAssignMPI(rank, size);
 }
 
+// Modification transaction as a python context manager, ie.
+//   with sg.ModificationTransaction():
+//     ...
+struct PyModificationTransaction
+{
+  void enter()
+  {
+    Node::beginTransaction();
+  }
+
+  void exit(py::args)
+  {
+    Node::endTransaction();
+  }
+};
+
 // OSPNode typedefs //////////////////////////////////////////////////////
 
 typedef OSPNode<ospray::cpp::Camera, NodeType::CAMERA> OSPNodeCamera;
@@ -282,6 +298,8 @@ PYBIND11_MODULE(pysg, sg)
   sg.def("createNode",
       py::overload_cast<std::string, std::string, rkcommon::utility::Any>(
           &createNode));
+  sg.def("createNodes", &createNodes);
+  sg.def("registeredNodeTypes", &registeredNodeTypes);
 
   // Plugins ////////////////////////////////////////////
   sg.def("loadPlugin", py::overload_cast<const std::string &>(&loadPlugin));
@@ -355,6 +373,19 @@ PYBIND11_MODULE(pysg, sg)
 
   // Generic Node class definition ////////////////////////////////////////////
 
+  py::enum_<CommitMode>(sg, "CommitMode")
+      .value("FULL", CommitMode::FULL)
+      .value("DIRTY_PATHS", CommitMode::DIRTY_PATHS);
+
+  py::enum_<CloneMode>(sg, "CloneMode")
+      .value("SHALLOW", CloneMode::SHALLOW)
+      .value("DEEP", CloneMode::DEEP);
+
+  py::class_<PyModificationTransaction>(sg, "ModificationTransaction")
+      .def(py::init<>())
+      .def("__enter__", &PyModificationTransaction::enter)
+      .def("__exit__", &PyModificationTransaction::exit);
+
   py::class_<Node, std::shared_ptr<Node>>(sg, "Node")
       .def(py::init<>())
       .def("keys", [](const Node &node) {
@@ -412,7 +443,12 @@ PYBIND11_MODULE(pysg, sg)
               &Node::add))
       .def("remove",
           static_cast<void (Node::*)(const std::string &)>(&Node::remove))
-      .def("commit", &Node::commit)
+      .def("commit", py::overload_cast<>(&Node::commit))
+      .def("commit", py::overload_cast<CommitMode>(&Node::commit))
+      .def("clone",
+          &Node::clone,
+          py::arg("mode") = CloneMode::DEEP,
+          py::arg("name") = "")
       .def("render", py::overload_cast<>(&Node::render))
       .def("child", &Node::child, py::return_value_policy::reference)
       .def("createChildData",
@@ -421,6 +457,9 @@ PYBIND11_MODULE(pysg, sg)
       .def("createChildData",
           static_cast<void (Node::*)(std::string, vec3f &)>(
               &Node::createChildData))
+      .def_static("beginTransaction", &Node::beginTransaction)
+      .def_static("endTransaction", &Node::endTransaction)
+      .def_static("inTransaction", &Node::inTransaction)
       .def("setSGOnly", &Node::setSGOnly)
       .def("subType", &Node::subType);
 
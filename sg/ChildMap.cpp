@@ -0,0 +1,190 @@
+// Copyright 2009 Intel Corporation
+// SPDX-License-Identifier: Apache-2.0
+
+#include "ChildMap.h"
+// stl
+#include <algorithm>
+#include <functional>
+
+namespace ospray {
+namespace sg {
+
+///////////////////////////////////////////////////////////////////////////////
+// ChildMap ///////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+constexpr size_t ChildMap::indexThreshold;
+constexpr size_t ChildMap::npos;
+constexpr size_t ChildMap::emptyBucket;
+constexpr size_t ChildMap::removedBucket;
+
+ChildMap::~ChildMap() = default;
+
+ChildMap::ChildMap(const ChildMap &o)
+{
+  *this = o;
+}
+
+ChildMap &ChildMap::operator=(const ChildMap &o)
+{
+  if (this == &o)
+    return *this;
+
+  clear();
+  reserve(o.size());
+  for (auto &item : o)
+    items.push_back(item);
+
+  if (items.size() > indexThreshold)
+    buildIndex();
+
+  return *this;
+}
+
+NodePtr &ChildMap::operator[](const std::string &name)
+{
+  auto i = lookup(name);
+  if (i != npos)
+    return items[i].second;
+
+  items.emplace_back(name, nullptr);
+  i = items.size() - 1;
+
+  if (index) {
+    index->hashes.push_back(std::hash<std::string>()(name));
+    index->erased.push_back(false);
+    if ((index->numUsed + 1) * 2 > index->buckets.size())
+      buildIndex();
+    else
+      placeSlot(i);
+  } else if (items.size() > indexThreshold) {
+    buildIndex();
+  }
+
+  return items[i].second;
+}
+
+size_t ChildMap::erase(const std::string &name)
+{
+  auto i = lookup(name);
+  if (i == npos)
+    return 0;
+
+  eraseSlot(i);
+  return 1;
+}
+
+void ChildMap::clear()
+{
+  items.clear();
+  index.reset();
+}
+
+void ChildMap::reserve(size_t size)
+{
+  items.reserve(size);
+}
+
+size_t ChildMap::lookup(const std::string &name) const
+{
+  if (index) {
+    const size_t hash = std::hash<std::string>()(name);
+    const size_t mask = index->buckets.size() - 1;
+    for (size_t b = hash & mask;; b = (b + 1) & mask) {
+      const size_t s = index->buckets[b];
+      if (s == emptyBucket)
+        return npos;
+      if (s != removedBucket && index->hashes[s - 1] == hash
+          && items[s - 1].first == name)
+        return s - 1;
+    }
+  }
+
+  auto itr = std::find_if(items.begin(), items.end(), [&](const item_t &item) {
+    return item.first == name;
+  });
+  return itr == items.end() ? npos : size_t(itr - items.begin());
+}
+
+void ChildMap::eraseSlot(size_t i)
+{
+  // Release the node only after the map is consistent again, its destructor
+  // may call back into the map
+  NodePtr released = std::move(items[i].second);
+
+  if (!index) {
+    // Small lists keep a plain ordered vector
+    items.erase(items.begin() + i);
+    return;
+  }
+
+  const size_t mask = index->buckets.size() - 1;
+  size_t b = index->hashes[i] & mask;
+  while (index->buckets[b] != i + 1)
+    b = (b + 1) & mask;
+  index->buckets[b] = removedBucket;
+
+  items[i].first.clear();
+  index->erased[i] = true;
+  index->numErased++;
+
+  // Compact once half of the slots are tombstones, amortized O(1) per erase
+  if (index->numErased * 2 > items.size())
+    compact();
+}
+
+void ChildMap::buildIndex()
+{
+  // Also used to grow the table, dropping removed markers; erased items keep
+  // their tombstones until compact()
+  std::unique_ptr<Index> old = std::move(index);
+  index.reset(new Index);
+
+  size_t numBuckets = 16;
+  while (numBuckets < items.size() * 4)
+    numBuckets *= 2;
+  index->buckets.assign(numBuckets, emptyBucket);
+
+  if (old) {
+    index->hashes = std::move(old->hashes);
+    index->erased = std::move(old->erased);
+    index->numErased = old->numErased;
+  } else {
+    index->hashes.reserve(items.size());
+    for (auto &item : items)
+      index->hashes.push_back(std::hash<std::string>()(item.first));
+    index->erased.assign(items.size(), false);
+  }
+
+  for (size_t i = 0; i < items.size(); ++i)
+    if (!index->erased[i])
+      placeSlot(i);
+}
+
+void ChildMap::placeSlot(size_t i)
+{
+  const size_t mask = index->buckets.size() - 1;
+  size_t b = index->hashes[i] & mask;
+  while (index->buckets[b] != emptyBucket && index->buckets[b] != removedBucket)
+    b = (b + 1) & mask;
+  if (index->buckets[b] == emptyBucket)
+    index->numUsed++;
+  index->buckets[b] = i + 1;
+}
+
+void ChildMap::compact()
+{
+  std::vector<item_t> live;
+  live.reserve(size());
+  for (size_t i = 0; i < items.size(); ++i)
+    if (!index->erased[i])
+      live.push_back(std::move(items[i]));
+  items.swap(live);
+
+  index.reset();
+  if (items.size() > indexThreshold / 2)
+    buildIndex();
+}
+
+} // namespace sg
+} // namespace ospray
@@ -0,0 +1,278 @@
+// Copyright 2009 Intel Corporation
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+// stl
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#ifndef OSPSG_INTERFACE
+#ifdef _WIN32
+#ifdef ospray_sg_EXPORTS
+#define OSPSG_INTERFACE __declspec(dllexport)
+#else
+#define OSPSG_INTERFACE __declspec(dllimport)
+#endif
+#define OSPSG_DLLEXPORT __declspec(dllexport)
+#else
+#define OSPSG_INTERFACE
+#define OSPSG_DLLEXPORT
+#endif
+#endif
+
+namespace ospray {
+namespace sg {
+
+struct Node;
+using NodePtr = std::shared_ptr<Node>;
+
+///////////////////////////////////////////////////////////////////////////////
+// Node children container ////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+// Insertion-ordered name -> NodePtr map with the same interface as the
+// rkcommon FlatMap it replaces. Small child lists are searched linearly,
+// once a node has more than 'indexThreshold' children a per-map open
+// addressing index over the names' hashes makes add, remove and lookup O(1).
+// The hash of each entry is kept next to it, so removing never rehashes the
+// name. In indexed mode removed entries are tombstoned and compacted away in
+// bulk, preserving order.
+class OSPSG_INTERFACE ChildMap
+{
+ public:
+  using item_t = std::pair<std::string, NodePtr>;
+
+  static constexpr size_t indexThreshold = 64;
+
+  template <typename MAP_T, typename ITEM_T>
+  class iterator_base
+  {
+   public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = item_t;
+    using difference_type = std::ptrdiff_t;
+    using pointer = ITEM_T *;
+    using reference = ITEM_T &;
+
+    iterator_base() = default;
+    iterator_base(MAP_T *_map, size_t _i) : map(_map), i(_i)
+    {
+      skipErased();
+    }
+
+    // allow iterator -> const_iterator conversion
+    template <typename OM, typename OI>
+    iterator_base(const iterator_base<OM, OI> &o) : map(o.map), i(o.i)
+    {}
+
+    reference operator*() const
+    {
+      return map->items[i];
+    }
+
+    pointer operator->() const
+    {
+      return &map->items[i];
+    }
+
+    iterator_base &operator++()
+    {
+      ++i;
+      skipErased();
+      return *this;
+    }
+
+    iterator_base operator++(int)
+    {
+      auto tmp = *this;
+      ++(*this);
+      return tmp;
+    }
+
+    bool operator==(const iterator_base &o) const
+    {
+      return i == o.i;
+    }
+
+    bool operator!=(const iterator_base &o) const
+    {
+      return i != o.i;
+    }
+
+   private:
+    void skipErased()
+    {
+      while (i < map->items.size() && map->isErased(i))
+        ++i;
+    }
+
+    MAP_T *map{nullptr};
+    size_t i{0};
+
+    template <typename, typename>
+    friend class iterator_base;
+    friend class ChildMap;
+  };
+
+  using iterator = iterator_base<ChildMap, item_t>;
+  using const_iterator = iterator_base<const ChildMap, const item_t>;
+
+  ChildMap() = default;
+  ~ChildMap();
+
+  ChildMap(const ChildMap &);
+  ChildMap &operator=(const ChildMap &);
+
+  // Key-based lookups //
+
+  NodePtr &at(const std::string &name);
+  const NodePtr &at(const std::string &name) const;
+
+  // Returns the existing entry or appends a new (null) one
+  NodePtr &operator[](const std::string &name);
+
+  iterator find(const std::string &name);
+  const_iterator find(const std::string &name) const;
+
+  // Property queries //
+
+  size_t size() const;
+  bool empty() const;
+  bool contains(const std::string &name) const;
+  bool indexed() const;
+
+  // Storage mutation //
+
+  size_t erase(const std::string &name);
+  void clear();
+  void reserve(size_t size);
+
+  // Iterators //
+
+  iterator begin();
+  iterator end();
+  const_iterator begin() const;
+  const_iterator end() const;
+  const_iterator cbegin() const;
+  const_iterator cend() const;
+
+ private:
+  struct Index
+  {
+    // item slot + 1 per bucket, linearly probed, kept at most half full
+    std::vector<size_t> buckets;
+    size_t numUsed{0}; // buckets holding a slot or a removed marker
+    // per item
+    std::vector<size_t> hashes;
+    std::vector<bool> erased;
+    size_t numErased{0};
+  };
+
+  static constexpr size_t npos = size_t(-1);
+  static constexpr size_t emptyBucket = 0;
+  static constexpr size_t removedBucket = size_t(-1);
+
+  size_t lookup(const std::string &name) const;
+  bool isErased(size_t i) const;
+  void eraseSlot(size_t i);
+  void buildIndex();
+  void placeSlot(size_t i);
+  void compact();
+
+  std::vector<item_t> items;
+  // only allocated while the map holds more than indexThreshold children
+  std::unique_ptr<Index> index;
+};
+
+// Inlined definitions ////////////////////////////////////////////////////////
+
+inline NodePtr &ChildMap::at(const std::string &name)
+{
+  auto i = lookup(name);
+  if (i == npos)
+    throw std::out_of_range("ChildMap::at(): no child named '" + name + "'");
+  return items[i].second;
+}
+
+inline const NodePtr &ChildMap::at(const std::string &name) const
+{
+  auto i = lookup(name);
+  if (i == npos)
+    throw std::out_of_range("ChildMap::at(): no child named '" + name + "'");
+  return items[i].second;
+}
+
+inline ChildMap::iterator ChildMap::find(const std::string &name)
+{
+  auto i = lookup(name);
+  return i == npos ? end() : iterator(this, i);
+}
+
+inline ChildMap::const_iterator ChildMap::find(const std::string &name) const
+{
+  auto i = lookup(name);
+  return i == npos ? end() : const_iterator(this, i);
+}
+
+inline size_t ChildMap::size() const
+{
+  return items.size() - (index ? index->numErased : 0);
+}
+
+inline bool ChildMap::isErased(size_t i) const
+{
+  return index && index->numErased && index->erased[i];
+}
+
+inline bool ChildMap::empty() const
+{
+  return size() == 0;
+}
+
+inline bool ChildMap::contains(const std::string &name) const
+{
+  return lookup(name) != npos;
+}
+
+inline bool ChildMap::indexed() const
+{
+  return index != nullptr;
+}
+
+inline ChildMap::iterator ChildMap::begin()
+{
+  return iterator(this, 0);
+}
+
+inline ChildMap::iterator ChildMap::end()
+{
+  return iterator(this, items.size());
+}
+
+inline ChildMap::const_iterator ChildMap::begin() const
+{
+  return const_iterator(this, 0);
+}
+
+inline ChildMap::const_iterator ChildMap::end() const
+{
+  return const_iterator(this, items.size());
+}
+
+inline ChildMap::const_iterator ChildMap::cbegin() const
+{
+  return begin();
+}
+
+inline ChildMap::const_iterator ChildMap::cend() const
+{
+  return end();
+}
+
+} // namespace sg
+} // namespace ospray
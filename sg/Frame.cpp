@@ -23,6 +23,52 @@ Frame::Frame()
   child("scaleNav").setReadOnly();
   child("navMode").setReadOnly();
 
+  // While navigating, scaleNav (and optionally the renderer's pixelSamples)
+  // follow the frame time measured against the target
+  auto &dr = createChild("dynamicResolution", "Node");
+  dr.createChild("targetFrameTime",
+      "float",
+      "navigation frame time to meet in ms, 0 disables dynamic resolution",
+      0.f);
+  dr.createChild("hysteresis",
+      "float",
+      "fraction of the target within which frame times are accepted",
+      0.2f);
+  dr.createChild("scaleMin", "float", "lowest navigation scale", 0.125f);
+  dr.createChild("scaleMax", "float", "highest navigation scale", 1.f);
+  dr.createChild("adjustPixelSamples",
+      "bool",
+      "trade pixel samples once the scale is at its limits",
+      false);
+  dr.createChild(
+      "frameTime", "float", "measured navigation frame time in ms", 0.f);
+  dr.createChild("pixelSamples",
+      "int",
+      "navigation pixel samples, 0 while not adjusted",
+      0);
+
+  dr["targetFrameTime"].setMinMax(0.f, 1000.f);
+  dr["hysteresis"].setMinMax(0.f, 1.f);
+  dr["scaleMin"].setMinMax(0.01f, 8.f);
+  dr["scaleMax"].setMinMax(0.01f, 8.f);
+  dr["frameTime"].setReadOnly();
+  dr["pixelSamples"].setReadOnly();
+
+  // While not navigating, only the region of interest is rendered, into a
+  // framebuffer of its size
+  auto &roi = createChild("roi", "Node");
+  roi.createChild("enabled",
+      "bool",
+      "render only the region of interest while not navigating",
+      false);
+  roi.createChild("start",
+      "vec2f",
+      "corner of the region, in normalized image coordinates",
+      vec2f(0.f));
+  roi.createChild("end", "vec2f", "opposite corner of the region", vec2f(1.f));
+  roi["start"].setMinMax(0.f, 1.f);
+  roi["end"].setMinMax(0.f, 1.f);
+
   // Shared by all frames
   baseMaterialRegistry = sg::createNodeAs<sg::MaterialRegistry>(
       "baseMaterialRegistry", "materialRegistry");
@@ -50,6 +96,9 @@ void Frame::startNewFrame()
   // This will update all nodes that are watching for file changes
   checkFileWatcherModifications();
 
+  updateDynamicResolution();
+  updateRegionOfInterest();
+
   // If working on a frame, cancel it, something has changed
   if (isModified()) {
     cancelFrame();
@@ -59,15 +108,18 @@ void Frame::startNewFrame()
 
   refreshFrameOperations();
 
-  // Commit only when modified
+  // Commit only when modified, following only the modified paths
   if (isModified())
-    commit();
+    commit(CommitMode::DIRTY_PATHS);
 
   if (!(pauseRendering || accumLimitReached() || varThresholdReached())) {
     auto future = fb.handle().renderFrame(
         renderer.handle(), camera.handle(), world.handle());
     setHandle(future, false); // setHandle but don't update modified time
     canceled = false;
+    measuringNavFrame = navMode
+        && child("dynamicResolution")["targetFrameTime"].valueAs<float>() > 0.f;
+    fullStillFrame = !navMode && !roiActive;
 
     if (immediatelyWait)
       waitOnFrame();
@@ -156,6 +208,163 @@ void Frame::unmapFrame(void *mem)
   fb.unmap(mem);
 }
 
+void Frame::updateDynamicResolution()
+{
+  auto &dr = child("dynamicResolution");
+  auto &renderer = child("renderer");
+  const float target = dr["targetFrameTime"].valueAs<float>();
+
+  if (!navMode || target <= 0.f) {
+    navFrameTimes.clear();
+    measuringNavFrame = false;
+    // Still frames render with the samples as set
+    if (basePixelSamples > 0) {
+      if (ownsPixelSamples(renderer))
+        renderer["pixelSamples"] = basePixelSamples;
+      basePixelSamples = 0;
+      samplesRenderer.reset();
+      dr["pixelSamples"].setValue(0, false);
+    }
+    return;
+  }
+
+  // Only navigation frames which finished at the current settings count
+  if (!measuringNavFrame || canceled || !frameIsReady())
+    return;
+  measuringNavFrame = false;
+
+  // Averaged over a few frames, changes wait for as many frames at the new
+  // settings
+  constexpr size_t numFrameTimes = 4;
+  navFrameTimes.push_back(frameDuration() * 1000.f);
+  if (navFrameTimes.size() < numFrameTimes)
+    return;
+
+  float frameTime = 0.f;
+  for (auto t : navFrameTimes)
+    frameTime += t;
+  frameTime /= navFrameTimes.size();
+  navFrameTimes.clear();
+  dr["frameTime"].setValue(frameTime, false);
+
+  const float hysteresis = dr["hysteresis"].valueAs<float>();
+  if (std::abs(frameTime - target) <= hysteresis * target)
+    return;
+
+  // Frame time is about proportional to the number of pixels, the square of
+  // the scale. Steps are limited to half or twice the pixels.
+  const float ratio = clamp(target / std::max(frameTime, 1e-3f), 0.5f, 2.f);
+  const float scaleMin = dr["scaleMin"].valueAs<float>();
+  const float scaleMax = std::max(scaleMin, dr["scaleMax"].valueAs<float>());
+  const float scale = child("scaleNav").valueAs<float>();
+
+  // Snapped so that the framebuffer size doesn't change for nothing
+  float newScale = std::round(scale * std::sqrt(ratio) * 64.f) / 64.f;
+  newScale = clamp(newScale, scaleMin, scaleMax);
+
+  if (newScale != scale) {
+    child("scaleNav") = newScale;
+    return;
+  }
+
+  // The scale is at a limit, trade samples instead, up to those set
+  if (!dr["adjustPixelSamples"].valueAs<bool>())
+    return;
+
+  // Samples set by the user or on another renderer are the new base
+  const int pixelSamples = renderer["pixelSamples"].valueAs<int>();
+  if (basePixelSamples == 0 || !ownsPixelSamples(renderer)) {
+    basePixelSamples = pixelSamples;
+    writtenPixelSamples = pixelSamples;
+    samplesRenderer = renderer.shared_from_this();
+  }
+
+  const int newPixelSamples = ratio < 1.f
+      ? std::max(1, int(pixelSamples * ratio))
+      : std::min(basePixelSamples,
+          std::max(pixelSamples + 1, int(pixelSamples * ratio)));
+
+  if (newPixelSamples != pixelSamples) {
+    renderer["pixelSamples"] = newPixelSamples;
+    writtenPixelSamples = newPixelSamples;
+    dr["pixelSamples"].setValue(newPixelSamples, false);
+  }
+}
+
+bool Frame::ownsPixelSamples(Node &renderer) const
+{
+  return samplesRenderer.lock().get() == &renderer
+      && renderer["pixelSamples"].valueAs<int>() == writtenPixelSamples;
+}
+
+void Frame::updateRegionOfInterest()
+{
+  auto &roi = child("roi");
+  const box2f fullImage(vec2f(0.f), vec2f(1.f));
+
+  if (!roi["enabled"].valueAs<bool>() || navMode)
+    roiNeedsFullFrame = true;
+  else if (fullStillFrame && frameIsReady() && !canceled)
+    roiNeedsFullFrame = false;
+
+  box2f region = fullImage;
+  if (!roiNeedsFullFrame) {
+    auto start = roi["start"].valueAs<vec2f>();
+    auto end = roi["end"].valueAs<vec2f>();
+    region.lower = max(vec2f(0.f), min(vec2f(1.f), min(start, end)));
+    region.upper = max(vec2f(0.f), min(vec2f(1.f), max(start, end)));
+    // an empty region renders the full image
+    if (region.upper.x <= region.lower.x || region.upper.y <= region.lower.y)
+      region = fullImage;
+  }
+
+  roiRegion = region;
+  roiActive = region.lower != fullImage.lower || region.upper != fullImage.upper;
+
+  // Only set when changed, setting marks the frame modified
+  auto &camera = child("camera");
+  if (camera["roiStart"].valueAs<vec2f>() != region.lower)
+    camera["roiStart"] = region.lower;
+  if (camera["roiEnd"].valueAs<vec2f>() != region.upper)
+    camera["roiEnd"] = region.upper;
+}
+
+// Size of a pixel in 'channel', as mapped
+static size_t bytesPerPixel(OSPFrameBufferChannel channel, bool floatFormat)
+{
+  switch (channel) {
+  case OSP_FB_COLOR:
+    return floatFormat ? sizeof(vec4f) : sizeof(uint32_t);
+  case OSP_FB_ACCUM:
+    return sizeof(vec4f);
+  case OSP_FB_NORMAL:
+  case OSP_FB_ALBEDO:
+    return sizeof(vec3f);
+  default: // depth, variance and IDs
+    return sizeof(uint32_t);
+  }
+}
+
+const Frame::FrontBuffer &Frame::swapBuffers(OSPFrameBufferChannel channel)
+{
+  auto &fb = childAs<FrameBuffer>("framebuffer");
+  front.size = fb["size"].valueAs<vec2i>();
+  front.channel = channel;
+  front.floatFormat = fb.isFloatFormat();
+  front.region = roiRegion;
+  front.regionOfInterest = roiActive;
+
+  const auto *mapped = static_cast<const uint8_t *>(mapFrame(channel));
+  // The front buffer keeps its allocation while the size doesn't change
+  front.data.assign(mapped,
+      mapped
+          + size_t(front.size.x) * front.size.y
+              * bytesPerPixel(channel, front.floatFormat));
+  fb.unmap(mapped);
+
+  return front;
+}
+
 void Frame::saveFrame(std::string filename, int flags)
 {
   auto &fb = childAs<FrameBuffer>("framebuffer");
@@ -200,6 +409,11 @@ void Frame::preCommit()
       : child("scale").valueAs<float>());
 
   auto newSize = (vec2i)(child("windowSize").valueAs<vec2i>() * scale);
+  // The region of interest renders at the full resolution
+  if (roiActive) {
+    auto roiSize = vec2f(newSize) * roiRegion.size();
+    newSize = max(vec2i(1), vec2i(roiSize + vec2f(0.5f)));
+  }
   if (oldSize != newSize)
     fb["size"] = newSize;
 
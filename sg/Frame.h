@@ -57,6 +57,40 @@ namespace ospray {
     void unmapFrame(void *mem);
     void saveFrame(std::string filename, int flags);
 
+    // A channel of the last finished frame, copied out of the framebuffer so
+    // it can be displayed while the next frame renders into it
+    struct FrontBuffer
+    {
+      vec2i size{0};
+      OSPFrameBufferChannel channel{OSP_FB_COLOR};
+      bool floatFormat{false}; // of the color channel
+      // part of the image it holds, normalized with the origin lower left
+      box2f region{vec2f(0.f), vec2f(1.f)};
+      bool regionOfInterest{false};
+      std::vector<uint8_t> data;
+
+      template <typename T>
+      const T *as() const
+      {
+        return reinterpret_cast<const T *>(data.data());
+      }
+    };
+
+    // Waits for the frame in flight and copies its 'channel' to the front
+    // buffer, startNewFrame() can render the next one right after
+    const FrontBuffer &swapBuffers(OSPFrameBufferChannel = OSP_FB_COLOR);
+
+    inline const FrontBuffer &frontBuffer() const
+    {
+      return front;
+    }
+
+    // Whether the frame in flight only renders the region of interest
+    inline bool renderingRegionOfInterest() const
+    {
+      return roiActive;
+    }
+
     bool immediatelyWait{false};
     bool pauseRendering{false};
     int accumLimit{0};
@@ -69,6 +103,29 @@ namespace ospray {
 
    private:
     bool navMode{false};
+    FrontBuffer front;
+
+    // Dynamic resolution: frame times (ms) measured at the current settings,
+    // whether the frame in flight counts towards them, and the renderer's
+    // pixelSamples to restore after navigating (0 if untouched) unless the
+    // renderer or its value changed since it was last written
+    std::vector<float> navFrameTimes;
+    bool measuringNavFrame{false};
+    int basePixelSamples{0};
+    int writtenPixelSamples{0};
+    std::weak_ptr<Node> samplesRenderer;
+    void updateDynamicResolution();
+    bool ownsPixelSamples(Node &renderer) const;
+
+    // Region of interest: part of the image the frame in flight renders. The
+    // region is shown over the last full frame, so a full still frame has to
+    // finish first.
+    box2f roiRegion{vec2f(0.f), vec2f(1.f)};
+    bool roiActive{false};
+    bool roiNeedsFullFrame{true};
+    bool fullStillFrame{false};
+    void updateRegionOfInterest();
+
     void refreshFrameOperations();
     void preCommit() override;
     void postCommit() override;
@@ -55,6 +55,19 @@ void from_json(const JSON &j, Any &a);
 namespace ospray {
 namespace sg {
 
+inline void to_json(JSON &j, const Node &n);
+
+inline void to_json(JSON &j, const ChildMap &cm)
+{
+  for (const auto &e : cm) {
+    JSON jnew = *(e.second);
+    if (!jnew.is_null())
+      j.push_back(jnew);
+  }
+}
+
+inline void from_json(const JSON &, ChildMap &) {}
+
 inline void to_json(JSON &j, const Node &n)
 {
   // Don't export these nodes, they must be regenerated and can't be imported.
@@ -2,33 +2,56 @@
 // SPDX-License-Identifier: Apache-2.0
 
 #include "Node.h"
+#include "SearchIndex.h"
 #include "visitors/Commit.h"
-#include "visitors/GetBounds.h"
 #include "visitors/RenderScene.h"
 // rkcommon
 #include "rkcommon/os/library.h"
 #include "rkcommon/utility/StringManip.h"
+// std
+#include <algorithm>
+#include <atomic>
+#include <mutex>
 
 namespace ospray {
   namespace sg {
 
   /////////////////////////////////////////////////////////////////////////////
 
+  // Record of all nodes created without a description or range
+  static const NodeMetadataPtr &defaultMetadata()
+  {
+    static const NodeMetadataPtr metadata =
+        NodeMetadata::intern({"<no description>", {}});
+    return metadata;
+  }
+
   Node::Node()
   {
     // NOTE(jda) - can't do default member initializers due to MSVC...
     properties.name        = "NULL";
     properties.type        = NodeType::GENERIC;
     properties.subType     = "Node";
-    properties.description = "<no description>";
+    properties.metadata    = defaultMetadata();
     properties.readOnly    = false;
   }
 
   Node::~Node()
   {
     // When destroying a node, remove it from its parents' list of children
-    for (auto &p : properties.parents)
-      p->properties.children.erase(properties.name);
+    ParentList parents;
+    {
+      std::lock_guard<SpinLock> lock(properties.structureLock);
+      parents.swap(properties.parents);
+    }
+    for (auto &p : parents) {
+      std::lock_guard<SpinLock> lock(p->properties.structureLock);
+      // don't release a different node under the same name while locked
+      auto itr = p->properties.children.find(properties.name);
+      if (itr != p->properties.children.end() && itr->second.get() == this)
+        p->properties.children.erase(properties.name);
+      p->properties.dirtyChildren.erase(this);
+    }
     // and from all its children's ParentList
     for (auto &c : properties.children)
       c.second->removeFromParentList(*this);
@@ -55,7 +78,7 @@ namespace ospray {
 
   std::string Node::description() const
   {
-    return properties.description;
+    return properties.metadata->description;
   }
 
   size_t Node::uniqueID() const
@@ -80,34 +103,36 @@ namespace ospray {
 
   Any Node::value()
   {
-    return properties.value;
+    return inlineValueType ? inlineValueAsAny() : properties.value;
   }
 
   const Any Node::value() const
   {
-    return properties.value;
+    return inlineValueType ? inlineValueAsAny() : properties.value;
+  }
+
+  bool Node::assignInlineValue(const Any &, bool &)
+  {
+    return false;
+  }
+
+  Any Node::inlineValueAsAny() const
+  {
+    return Any();
   }
 
   /////////////////////////////////////////////////////////////////////////////
   // Parent-child structural interface /////////////////////////////////////////
   /////////////////////////////////////////////////////////////////////////////
 
-  const FlatMap<std::string, NodePtr> &Node::children() const
+  const ChildMap &Node::children() const
   {
     return properties.children;
   }
 
- bool Node::hasChild(const std::string &name) const
+  bool Node::hasChild(const std::string &name) const
   {
-    auto &c = properties.children;
-    if (c.contains(name))
-      return true;
-
-    auto itr = std::find_if(c.cbegin(), c.cend(), [&](const NodeLink &n) {
-      return n.first == name;
-    });
-
-    return itr != properties.children.end();
+    return properties.children.contains(name);
   }
 
   bool Node::hasChildOfSubType(const std::string &subType) const
@@ -121,7 +146,7 @@ namespace ospray {
     return itr != properties.children.end();
   }
 
-    bool Node::hasChildOfType(NodeType type) const
+  bool Node::hasChildOfType(NodeType type) const
   {
     auto &c = properties.children;
 
@@ -134,15 +159,9 @@ namespace ospray {
 
   Node &Node::child(const std::string &name)
   {
-    auto &c = properties.children;
-    if (c.contains(name))
-      return *c[name];
-
-    auto itr = std::find_if(c.begin(), c.end(), [&](const NodeLink &n) {
-      return n.first == name;
-    });
+    auto itr = properties.children.find(name);
 
-    if (itr == properties.children.cend()) {
+    if (itr == properties.children.end()) {
       throw std::runtime_error(
           "in " + subType() + " node '" + this->name() + "'" +
           ": could not find sg child node with name '" + name + "'");
@@ -185,7 +204,7 @@ namespace ospray {
     return !properties.children.empty();
   }
 
-  const std::vector<Node *> &Node::parents() const
+  const ParentList &Node::parents() const
   {
     return properties.parents;
   }
@@ -212,24 +231,66 @@ namespace ospray {
 
   void Node::add(NodePtr node, const std::string &name)
   {
-    if (hasChild(name)) {
-      if (properties.children[name] == node)
-        return;
-      properties.children[name]->removeFromParentList(*this);
+    // Link the parent first: modifications of 'node' from here on reach this
+    // node, earlier ones are caught by the dirty check below
+    {
+      std::lock_guard<SpinLock> lock(node->properties.structureLock);
+      node->properties.parents.push_back(this);
+    }
+
+    NodePtr replaced;
+    {
+      std::lock_guard<SpinLock> lock(properties.structureLock);
+      auto &slot = properties.children[name];
+      replaced.swap(slot);
+      slot = node;
+      // an uncommitted subtree must be reachable from this node's dirty queue
+      if (node->subtreeModifiedButNotCommitted())
+        properties.dirtyChildren.insert(node.get());
     }
-    properties.children[name] = node;
-    node->properties.parents.push_back(this);
+
+    // Replaced nodes are released outside of the lock, their destructor may
+    // need it
+    if (replaced == node) {
+      // already a child under this name, undo the extra parent link
+      node->eraseParent(*this);
+      return;
+    }
+
+    // Recorded once linked both ways, the index walks the children of a
+    // node it indexes meanwhile
+    SearchIndex::linked(*this, *node);
+
+    if (replaced)
+      replaced->removeFromParentList(*this);
+
     markAsModified();
   }
 
   void Node::remove(Node &node)
   {
-    for (auto &child : properties.children) {
-      if (child.second.get() == &node) {
-        child.second->removeFromParentList(*this);
-        properties.children.erase(child.first);
-        return;
+    NodePtr removed;
+    {
+      std::lock_guard<SpinLock> lock(properties.structureLock);
+      auto &children = properties.children;
+
+      // Nodes are usually stored under their own name
+      auto itr = children.find(node.name());
+      if (itr == children.end() || itr->second.get() != &node) {
+        itr = std::find_if(children.begin(), children.end(), [&](NodeLink &c) {
+          return c.second.get() == &node;
+        });
       }
+
+      if (itr != children.end()) {
+        removed = itr->second;
+        children.erase(itr->first);
+      }
+    }
+
+    if (removed) {
+      removed->removeFromParentList(*this);
+      return;
     }
 
     markAsModified();
@@ -242,27 +303,126 @@ namespace ospray {
 
   void Node::remove(const std::string &name)
   {
-    for (auto &child : properties.children) {
-      if (child.first == name) {
-        child.second->removeFromParentList(*this);
-        properties.children.erase(child.first);
-        return;
+    NodePtr removed;
+    {
+      std::lock_guard<SpinLock> lock(properties.structureLock);
+      auto itr = properties.children.find(name);
+      if (itr != properties.children.end()) {
+        removed = itr->second;
+        properties.children.erase(name);
       }
     }
 
+    if (removed) {
+      removed->removeFromParentList(*this);
+      return;
+    }
+
     markAsModified();
   }
 
   void Node::removeAllParents()
   {
-    for (auto &p : properties.parents)
+    // remove() changes the parent list, iterate over a copy
+    ParentList parents;
+    {
+      std::lock_guard<SpinLock> lock(properties.structureLock);
+      parents = properties.parents;
+    }
+    for (auto &p : parents)
       p->remove(*this);
   }
 
   void Node::removeAllChildren()
   {
-    for (auto &c : properties.children)
-      remove(c.first);
+    // removing invalidates iteration, collect the names first
+    std::vector<std::string> names;
+    {
+      std::lock_guard<SpinLock> lock(properties.structureLock);
+      names.reserve(properties.children.size());
+      for (auto &c : properties.children)
+        names.push_back(c.first);
+    }
+    for (auto &n : names)
+      remove(n);
+  }
+
+  // Cloning //
+
+  // Heavy resources, DEEP clones link to these instead of copying them
+  static bool isSharedOnClone(const Node &node)
+  {
+    switch (node.type()) {
+    case NodeType::VOLUME:
+    case NodeType::TEXTURE:
+    case NodeType::TEXTUREVOLUME:
+      return true;
+    default:
+      return node.subType() == "Data";
+    }
+  }
+
+  NodePtr Node::clone(CloneMode mode, const std::string &name) const
+  {
+    // linking children would notify the new parents once per child
+    ModificationTransaction transaction;
+
+    auto copy = createNode(name.empty() ? properties.name : name,
+        properties.subType);
+
+    CloneMap copies;
+    copies[this] = copy;
+    copyInto(*copy, mode, copies);
+
+    return copy;
+  }
+
+  void Node::cloneValueFrom(const Node &source)
+  {
+    auto v = source.value();
+    if (v.valid())
+      setValue(v, false);
+  }
+
+  void Node::copyInto(Node &copy, CloneMode mode, CloneMap &copies) const
+  {
+    copy.properties.metadata    = properties.metadata;
+    copy.properties.origName    = properties.origName;
+    copy.properties.readOnly    = properties.readOnly;
+    copy.properties.sgOnly      = properties.sgOnly;
+    copy.properties.sgNoUI      = properties.sgNoUI;
+    copy.cloneValueFrom(*this);
+
+    for (auto &c : properties.children) {
+      auto &child = *c.second;
+      NodePtr childCopy;
+
+      if (mode == CloneMode::SHALLOW || isSharedOnClone(child)) {
+        childCopy = c.second;
+      } else {
+        // nodes reachable through several parents are copied once
+        auto found = copies.find(&child);
+        if (found != copies.end()) {
+          childCopy = found->second;
+        } else {
+          // Reuse children the copy's constructor already created, the node
+          // may keep references to them
+          auto existing = copy.properties.children.find(c.first);
+          if (existing != copy.properties.children.end()
+              && existing->second->subType() == child.subType()) {
+            copies[&child] = existing->second;
+            child.copyInto(*existing->second, mode, copies);
+            continue;
+          }
+
+          childCopy = createNode(child.properties.name, child.subType());
+          copies[&child] = childCopy;
+          child.copyInto(*childCopy, mode, copies);
+        }
+      }
+
+      copy.add(childCopy, c.first);
+    }
   }
 
   /////////////////////////////////////////////////////////////////////////////
@@ -271,7 +431,18 @@ namespace ospray {
 
   void Node::commit()
   {
-    traverse<CommitVisitor>();
+    commit(CommitMode::FULL);
+  }
+
+  void Node::commit(CommitMode mode)
+  {
+    // Parents must know about pending modifications before committing
+    flushTransaction();
+
+    if (mode == CommitMode::DIRTY_PATHS)
+      commitDirtyPaths();
+    else
+      traverse<CommitVisitor>();
   }
 
   void Node::render()
@@ -282,9 +453,74 @@ namespace ospray {
 
   box3f Node::bounds()
   {
-    GetBounds visitor;
-    traverse(visitor);
-    return visitor.bounds;
+    box3f result(empty);
+    cachedBounds(result);
+    return result;
+  }
+
+  bool Node::computeBounds(box3f &bounds)
+  {
+    bounds = box3f(empty);
+    bool complete = true;
+    for (auto &c : properties.children) {
+      box3f childBounds;
+      complete &= c.second->cachedBounds(childBounds);
+      bounds.extend(childBounds);
+    }
+    return complete;
+  }
+
+  bool Node::cachedBounds(box3f &bounds)
+  {
+    // Modification times only reach the ancestors once pending transaction
+    // changes are propagated, the cache would look up to date otherwise
+    if (inTransaction())
+      flushTransaction();
+
+    // Not worth a cache, a leaf only has bounds if it computes its own
+    if (properties.children.empty())
+      return computeBounds(bounds);
+
+    {
+      std::lock_guard<SpinLock> lock(properties.structureLock);
+      auto *cache = properties.boundsCache.get();
+      if (cache && cache->computed > properties.lastModified
+          && cache->computed > properties.childrenMTime) {
+        bounds = cache->bounds;
+        return true;
+      }
+    }
+
+    // Modifications made while computing are newer than this, the result
+    // is then outdated the next time around
+    TimeStamp computed;
+    computed.renew();
+
+    if (!computeBounds(bounds))
+      return false;
+
+    std::lock_guard<SpinLock> lock(properties.structureLock);
+    if (!properties.boundsCache)
+      properties.boundsCache.reset(new BoundsCache);
+    properties.boundsCache->bounds   = bounds;
+    properties.boundsCache->computed = computed;
+    return true;
+  }
+
+  void Node::invalidateBounds()
+  {
+    ParentList parents;
+    {
+      std::lock_guard<SpinLock> lock(properties.structureLock);
+      // ancestors can only have cached bounds if this node has
+      if (!properties.boundsCache)
+        return;
+      properties.boundsCache.reset();
+      parents = properties.parents;
+    }
+
+    for (auto *p : parents)
+      p->invalidateBounds();
   }
 
   /////////////////////////////////////////////////////////////////////////////
@@ -293,24 +529,23 @@ namespace ospray {
 
   Any Node::min() const
   {
-    return properties.minMax[0];
+    return properties.metadata->minMax[0];
   }
 
   Any Node::max() const
   {
-    return properties.minMax[1];
+    return properties.metadata->minMax[1];
   }
 
   void Node::setMinMax(const Any &minVal, const Any &maxVal)
   {
-    properties.minMax.resize(2);
-    properties.minMax[0] = minVal;
-    properties.minMax[1] = maxVal;
+    NodeMetadata metadata{properties.metadata->description, {minVal, maxVal}};
+    properties.metadata = NodeMetadata::intern(std::move(metadata));
   }
 
   bool Node::hasMinMax() const
   {
-    return (properties.minMax.size() > 1);
+    return (properties.metadata->minMax.size() > 1);
   }
 
   bool Node::readOnly() const
@@ -376,28 +611,179 @@ namespace ospray {
     return properties.childrenMTime;
   }
 
+  void Node::commitDirtyPaths()
+  {
+    // Same pre/post order as CommitVisitor, but only the children queued as
+    // dirty are looked at instead of every child of every modified node
+    if (!subtreeModifiedButNotCommitted())
+      return;
+
+    preCommit();
+
+    // Children queued from here on are left for the next commit
+    auto dirty = takeDirtyChildren();
+
+    if (dirty.size() == 1) {
+      (*dirty.begin())->commitDirtyPaths();
+    } else if (!dirty.empty()) {
+      // keep the traversal order of the full commit between siblings
+      for (auto &c : properties.children)
+        if (dirty.count(c.second.get()))
+          c.second->commitDirtyPaths();
+    }
+
+    if (subtreeModifiedButNotCommitted()) {
+      postCommit();
+      properties.lastCommitted.renew();
+    }
+  }
+
+  void Node::setDescription(std::string description)
+  {
+    if (description == properties.metadata->description)
+      return;
+
+    NodeMetadata metadata{std::move(description), properties.metadata->minMax};
+    properties.metadata = NodeMetadata::intern(std::move(metadata));
+  }
+
   void Node::removeFromParentList(Node &node)
   {
     node.markAsModified(); // Removal requires notifying parents
-    auto &p          = properties.parents;
-    auto remove_node = [&](auto np) { return np == &node; };
-    p.erase(std::remove_if(p.begin(), p.end(), remove_node), p.end());
+    {
+      std::lock_guard<SpinLock> lock(node.properties.structureLock);
+      node.properties.dirtyChildren.erase(this);
+    }
+
+    eraseParent(node);
+
+    // Nodes without an indexed parent leave the index
+    SearchIndex::unlinked(*this);
+  }
+
+  void Node::eraseParent(Node &node)
+  {
+    // A node added twice to the same parent is listed once per link
+    std::lock_guard<SpinLock> lock(properties.structureLock);
+    auto &p  = properties.parents;
+    auto itr = std::find(p.begin(), p.end(), &node);
+    if (itr != p.end())
+      p.erase(itr);
+  }
+
+  std::vector<Node *> Node::modifiedChildren()
+  {
+    std::lock_guard<SpinLock> lock(properties.structureLock);
+    return std::vector<Node *>(
+        properties.dirtyChildren.begin(), properties.dirtyChildren.end());
+  }
+
+  std::unordered_set<Node *> Node::takeDirtyChildren()
+  {
+    std::unordered_set<Node *> dirty;
+    std::lock_guard<SpinLock> lock(properties.structureLock);
+    dirty.swap(properties.dirtyChildren);
+    return dirty;
+  }
+
+  // Modification transactions ////////////////////////////////////////////////
+
+  static std::atomic<size_t> modificationEpoch{0};
+
+  static size_t nextModificationEpoch()
+  {
+    return ++modificationEpoch;
+  }
+
+  namespace {
+  struct TransactionState
+  {
+    int depth{0};
+    std::vector<NodePtr> pending;
+  };
+
+  thread_local TransactionState transaction;
+  } // namespace
+
+  void Node::beginTransaction()
+  {
+    transaction.depth++;
+  }
+
+  void Node::endTransaction()
+  {
+    if (transaction.depth == 0)
+      throw std::runtime_error("Node::endTransaction() without a transaction");
+
+    if (--transaction.depth == 0)
+      flushTransaction();
+  }
+
+  bool Node::inTransaction()
+  {
+    return transaction.depth > 0;
+  }
+
+  void Node::flushTransaction()
+  {
+    if (transaction.pending.empty())
+      return;
+
+    // One epoch for the whole transaction, shared ancestors are notified once
+    auto epoch = nextModificationEpoch();
+
+    std::vector<NodePtr> pending;
+    pending.swap(transaction.pending);
+    for (auto &n : pending)
+      n->propagateModified(epoch);
   }
 
   void Node::markAsModified()
   {
     // Mark all parents, up to root, as modified
     properties.lastModified.renew();
+
+    if (inTransaction()) {
+      std::lock_guard<SpinLock> lock(properties.structureLock);
+      if (!properties.parents.empty() && !properties.propagationPending) {
+        properties.propagationPending = true;
+        transaction.pending.push_back(shared_from_this());
+      }
+      return;
+    }
+
+    propagateModified(nextModificationEpoch());
+  }
+
+  void Node::propagateModified(size_t epoch)
+  {
+    std::lock_guard<SpinLock> lock(properties.structureLock);
+    properties.propagationPending = false;
+    notifyParents(epoch);
+  }
+
+  void Node::notifyParents(size_t epoch)
+  {
+    // Called with this node's lock held, parents are locked in turn above it
     for (auto &p : properties.parents)
-      p->updateChildrenModifiedTime();
+      p->updateChildrenModifiedTime(*this, epoch);
   }
 
-  void Node::updateChildrenModifiedTime()
+  void Node::updateChildrenModifiedTime(Node &child, size_t epoch)
   {
-    // Notify all parent of latest child modified time
+    std::lock_guard<SpinLock> lock(properties.structureLock);
+
+    // Notify all parent of latest child modified time, queueing the path to
+    // the modified child for CommitMode::DIRTY_PATHS
+    properties.dirtyChildren.insert(&child);
+
+    // Everything above was already notified during this epoch
+    if (properties.modifiedEpoch == epoch)
+      return;
+
+    properties.modifiedEpoch = epoch;
     properties.childrenMTime.renew();
-    for (auto &p : properties.parents)
-      p->updateChildrenModifiedTime();
+    notifyParents(epoch);
   }
 
   void Node::setOSPRayParam(std::string, OSPObject) {}
@@ -406,49 +792,173 @@ namespace ospray {
   // Global Stuff /////////////////////////////////////////////////////////////
   /////////////////////////////////////////////////////////////////////////////
 
-  using CreatorFct = Node *(*)();
+  struct NodeFactory
+  {
+    NodeCreatorFct creator{nullptr};
+    // plugins built with an older OSP_REGISTER_SG_NODE_NAME don't have one
+    PooledNodeCreatorFct pooledCreator{nullptr};
+    NodePool *pool{nullptr};
+  };
+
+  using NodeFactoryMap = std::unordered_map<std::string, NodeFactory>;
+
+  namespace {
+  // Published factory maps are immutable, lookups only load the current map.
+  // Registrations are queued while libraries load and merged into a new map
+  // on the next lookup miss. Old maps are kept, a reader may still use one.
+  struct NodeRegistry
+  {
+    std::atomic<const NodeFactoryMap *> current{nullptr};
 
-  static std::map<std::string, CreatorFct> nodeRegistry;
+    std::mutex mutex;
+    std::vector<std::pair<std::string, NodeFactory>> pending;
+    std::vector<std::unique_ptr<NodeFactoryMap>> published;
+    bool libraryLoaded{false};
+  };
 
-  std::shared_ptr<Node> createNode(std::string name,
-                                   std::string subtype,
-                                   std::string description,
-                                   Any value)
+  // any symbol within this library, used to locate it for symbol lookups
+  const char libraryAnchor = 0;
+
+  NodeRegistry &nodeRegistry()
+  {
+    // never destroyed, nodes are created during static destruction too
+    static NodeRegistry *registry = new NodeRegistry;
+    return *registry;
+  }
+
+  const NodeFactory *findNodeFactory(
+      const NodeFactoryMap *factories, const std::string &subtype)
+  {
+    if (!factories)
+      return nullptr;
+    auto it = factories->find(subtype);
+    return it == factories->end() ? nullptr : &it->second;
+  }
+
+  // Called with the registry mutex held
+  void publishNodeFactories(NodeRegistry &registry,
+      std::vector<std::pair<std::string, NodeFactory>> &&added)
   {
-    // Verify that 'ospray_sg' is properly loaded //
+    auto *previous = registry.current.load(std::memory_order_acquire);
+    std::unique_ptr<NodeFactoryMap> factories(
+        previous ? new NodeFactoryMap(*previous) : new NodeFactoryMap);
+
+    for (auto &f : added) {
+      if (f.second.pooledCreator)
+        f.second.pool = getNodePool(f.first);
+      (*factories)[f.first] = f.second;
+    }
+
+    registry.current.store(factories.get(), std::memory_order_release);
+    registry.published.push_back(std::move(factories));
+  }
 
-    static bool libraryLoaded = false;
-    if (!libraryLoaded) {
-      // the anchor can be any symbol within this library, use nodeRegistry
-      loadLibrary(reinterpret_cast<const void *>(&nodeRegistry), "ospray_sg");
-      libraryLoaded = true;
+  void publishPendingNodeFactories(NodeRegistry &registry)
+  {
+    if (!registry.pending.empty()) {
+      std::vector<std::pair<std::string, NodeFactory>> added;
+      added.swap(registry.pending);
+      publishNodeFactories(registry, std::move(added));
     }
+  }
+  } // namespace
 
-    // Look for the factory function to create the node //
+  NodeRegistrar::NodeRegistrar(const char *subtype,
+      NodeCreatorFct creator,
+      PooledNodeCreatorFct pooledCreator)
+  {
+    NodeFactory factory;
+    factory.creator       = creator;
+    factory.pooledCreator = pooledCreator;
+
+    auto &registry = nodeRegistry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    registry.pending.emplace_back(subtype, factory);
+  }
 
-    auto it = nodeRegistry.find(subtype);
+  std::vector<std::string> registeredNodeTypes()
+  {
+    auto &registry = nodeRegistry();
+    {
+      std::lock_guard<std::mutex> lock(registry.mutex);
+      publishPendingNodeFactories(registry);
+    }
 
-    CreatorFct creator = nullptr;
+    std::vector<std::string> subtypes;
+    if (auto *factories = registry.current.load(std::memory_order_acquire)) {
+      subtypes.reserve(factories->size());
+      for (auto &f : *factories)
+        subtypes.push_back(f.first);
+      std::sort(subtypes.begin(), subtypes.end());
+    }
+    return subtypes;
+  }
 
-    if (it == nodeRegistry.end()) {
-      std::string creatorName = "ospray_create_sg_node__" + subtype;
+  static const NodeFactory &getNodeFactory(const std::string &subtype)
+  {
+    auto &registry = nodeRegistry();
 
-      creator = (CreatorFct)getSymbol(creatorName);
-      if (!creator)
-        throw std::runtime_error("unknown node type '" + subtype + "'");
+    // Fast path, no locking //
 
-      nodeRegistry[subtype] = creator;
-    } else {
-      creator = it->second;
+    auto *factory = findNodeFactory(
+        registry.current.load(std::memory_order_acquire), subtype);
+    if (factory)
+      return *factory;
+
+    // Merge types registered by newly loaded libraries //
+
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    publishPendingNodeFactories(registry);
+
+    factory = findNodeFactory(
+        registry.current.load(std::memory_order_acquire), subtype);
+    if (factory)
+      return *factory;
+
+    // Fall back to a symbol lookup, for libraries which export creator
+    // functions without a registrar //
+
+    if (!registry.libraryLoaded) {
+      loadLibrary(&libraryAnchor, "ospray_sg");
+      registry.libraryLoaded = true;
     }
 
-    // Create the node and return //
+    NodeFactory found;
+    found.creator =
+        (NodeCreatorFct)getSymbol("ospray_create_sg_node__" + subtype);
+    if (!found.creator)
+      throw std::runtime_error("unknown node type '" + subtype + "'");
+
+    found.pooledCreator = (PooledNodeCreatorFct)getSymbol(
+        "ospray_create_pooled_sg_node__" + subtype);
+
+    publishNodeFactories(registry, {{subtype, found}});
+
+    return *findNodeFactory(
+        registry.current.load(std::memory_order_acquire), subtype);
+  }
+
+  static NodePtr instantiateNode(const NodeFactory &factory)
+  {
+    NodePtr newNode;
+    if (factory.pooledCreator)
+      factory.pooledCreator(factory.pool, &newNode);
+    else
+      newNode.reset(factory.creator());
+    return newNode;
+  }
+
+  std::shared_ptr<Node> createNode(std::string name,
+                                   std::string subtype,
+                                   std::string description,
+                                   Any value)
+  {
+    auto newNode = instantiateNode(getNodeFactory(subtype));
 
-    std::shared_ptr<sg::Node> newNode(creator());
-    newNode->properties.name        = name;
-    newNode->properties.subType     = subtype;
+    newNode->properties.name        = std::move(name);
+    newNode->properties.subType     = std::move(subtype);
     newNode->properties.type        = newNode->type();
-    newNode->properties.description = description;
+    newNode->setDescription(std::move(description));
 
     if (value.valid())
       newNode->setValue(value);
@@ -456,6 +966,29 @@ namespace ospray {
     return newNode;
   }
 
+  std::vector<NodePtr> createNodes(size_t count,
+                                   const std::string &subtype,
+                                   const std::string &baseName)
+  {
+    // Single registry lookup and slab reservation for the whole batch
+    const auto &factory = getNodeFactory(subtype);
+    if (factory.pool)
+      factory.pool->reserve(count);
+
+    std::vector<NodePtr> nodes;
+    nodes.reserve(count);
+
+    for (size_t i = 0; i < count; ++i) {
+      auto newNode = instantiateNode(factory);
+      newNode->properties.name        = baseName + "_" + std::to_string(i);
+      newNode->properties.subType     = subtype;
+      newNode->properties.type        = newNode->type();
+      nodes.push_back(std::move(newNode));
+    }
+
+    return nodes;
+  }
+
   NodePtr createNode(std::string name)
   {
     return createNode(name, "Node");
@@ -5,9 +5,13 @@
 
 #include "Visitor.h"
 // stl
+#include <atomic>
 #include <map>
 #include <unordered_map>
+#include <unordered_set>
 #include <memory>
+#include <typeinfo>
+#include <type_traits>
 #include <vector>
 // rkcommon
 #include "rkcommon/containers/FlatMap.h"
@@ -21,7 +25,12 @@
 #include "ospray/ospray_cpp/ext/rkcommon.h"
 // ospray_sg
 #include "version.h"
+#include "ChildMap.h"
+#include "NodeArena.h"
+#include "NodeMetadata.h"
 #include "NodeType.h"
+#include "ParentList.h"
+#include "SpinLock.h"
 
 #ifndef OSPSG_INTERFACE
 #ifdef _WIN32
@@ -64,6 +73,28 @@ namespace sg {
 
   struct Data;
 
+  // How Node::commit() finds the nodes which need to be committed
+  enum class CommitMode
+  {
+    // visit every child of every modified node, checking its timestamps
+    FULL,
+    // only follow the dirty-child queues recorded by markAsModified(), the
+    // cost scales with the number of edits rather than the size of the tree
+    DIRTY_PATHS
+  };
+
+  // What Node::clone() copies
+  enum class CloneMode
+  {
+    // a new node with the same value, linked to the same children
+    SHALLOW,
+    // copies of the whole subtree, except heavy resources (volumes,
+    // textures and Data arrays) which are shared by the copies. Geometry
+    // nodes are copied, so a copy can get other materials, and share their
+    // Data children and vertex arrays with the source.
+    DEEP
+  };
+
   struct OSPSG_INTERFACE Node : public std::enable_shared_from_this<Node>
   {
     Node();
@@ -126,7 +157,7 @@ namespace sg {
 
     // Children //
 
-    const FlatMap<std::string, NodePtr> &children() const;
+    const ChildMap &children() const;
 
     bool hasChildren() const;
 
@@ -150,12 +181,19 @@ namespace sg {
 
     // Parents //
 
-    const std::vector<Node *> &parents() const;
+    const ParentList &parents() const;
 
     bool hasParents() const;
 
     // Structural Changes (add/remove children) //
 
+    // Concurrency: add/remove and modification tracking lock the nodes they
+    // change (see 'structureLock'), so separate threads may build detached
+    // subgraphs which share nodes (e.g. importer parameters), and attach them
+    // under a common parent. Traversing or querying the children of a node
+    // while another thread changes that same node is not supported; attach
+    // to a graph that is being rendered from the thread that renders it.
+
     void add(Node &node);
     void add(Node &node, const std::string &name);
 
@@ -180,6 +218,10 @@ namespace sg {
 
     void createChildData(std::string name, std::shared_ptr<Data> data);
 
+    // Copy this node, named 'name' if not empty. The copy has no parents.
+    NodePtr clone(CloneMode mode = CloneMode::DEEP,
+        const std::string &name = "") const;
+
     // Public method for self or any children modified
     inline bool isModified()
     {
@@ -197,9 +239,20 @@ namespace sg {
     template <typename VISITOR_T, typename... Args>
     void traverse(Args &&... args);
 
+    //! Visit independent subtrees concurrently, the visitor has to support
+    //! ParallelSplit construction and reduce() (see Visitor.h)
+    template <typename VISITOR_T>
+    void traverseParallel(VISITOR_T &&visitor);
+
+    template <typename VISITOR_T, typename... Args>
+    void traverseParallel(Args &&... args);
+
     void commit();
-    void render();
+    void commit(CommitMode mode);
+    virtual void render();
 
+    // Bounds of this subtree in its own space. They're cached and only
+    // computed again once the subtree is modified.
     box3f bounds();
 
     virtual void setOSPRayParam(std::string param, OSPObject handle);
@@ -237,6 +290,16 @@ namespace sg {
     // Allow nodes to be marked as modified with no other modifications
     void markAsModified();
 
+    // Modification transactions //////////////////////////////////////////////
+
+    // While a transaction is open on the calling thread, markAsModified()
+    // only stamps the node itself. Notifying the parents up to the root is
+    // deferred until the outermost transaction ends (or commit() is called),
+    // then each modified path is notified exactly once.
+    static void beginTransaction();
+    static void endTransaction();
+    static bool inTransaction();
+
    protected:
     virtual void preCommit();
     virtual void postCommit();
@@ -246,74 +309,206 @@ namespace sg {
     TimeStamp lastCommitted() const;
     TimeStamp childrenLastModified() const;
 
-    void updateChildrenModifiedTime();
+    void updateChildrenModifiedTime(Node &child, size_t epoch);
+
+    // notify all parents, stopping at nodes already notified in 'epoch'
+    void propagateModified(size_t epoch);
+    void notifyParents(size_t epoch);
 
     bool subtreeModifiedButNotCommitted() const;
     bool anyChildModified() const;
 
+    // Children modified since this node was last committed, as queued for
+    // the commit. Complete in preCommit().
+    std::vector<Node *> modifiedChildren();
+
+    // Computes the bounds of this subtree when the cached ones are out of
+    // date, by default the union of the children's. Returns false if they
+    // are incomplete (e.g. nothing is known yet about a geometry), they
+    // aren't cached then.
+    virtual bool computeBounds(box3f &bounds);
+
+    // Cached bounds, computed first if needed. Returns false if incomplete.
+    // Inside a transaction, its pending modifications are propagated first.
+    bool cachedBounds(box3f &bounds);
+
+    // Drops the cached bounds of this node and its ancestors, for changes
+    // which don't modify the node (e.g. skinning)
+    void invalidateBounds();
+
+    // Copy the value of 'source' into a fresh clone of it
+    virtual void cloneValueFrom(const Node &source);
+
+    // Inline value storage, provided by Node_T<> for small POD types //
+
+    // Store 'val' in the inline value, false if its type doesn't fit
+    virtual bool assignInlineValue(const Any &val, bool &changed);
+    virtual Any inlineValueAsAny() const;
+
+    template <typename T>
+    T *inlineValuePtr() const;
+
+    // set by Node_T<> when it has inline storage
+    void *inlineValue{nullptr};
+    // non-null while the value lives in 'inlineValue' instead of the Any
+    const std::type_info *inlineValueType{nullptr};
+
    private:
     //! Use a custom provided node visitor to visit each node
     template <typename VISITOR_T>
     void traverse(VISITOR_T &&visitor, TraversalContext &ctx);
 
+    //! Parallel variant, splitting the visitor over children
+    template <typename VISITOR_T>
+    void traverseParallel(VISITOR_T &visitor, TraversalContext &ctx);
+
     //! Use a custom provided node visitor to visit each node
     template <typename VISITOR_T>
     void traverseAnimation(VISITOR_T &&visitor, TraversalContext &ctx);
 
+    //! Commit along the dirty-child queues only (CommitMode::DIRTY_PATHS)
+    void commitDirtyPaths();
+
+    struct BoundsCache
+    {
+      box3f bounds;
+      // renewed before the bounds are computed
+      TimeStamp computed;
+    };
+
     struct
     {
       std::string name;
-      NodeType type;
       std::string subType;
-      std::string description;
       std::string origName;
 
+      // description and min/max, shared between nodes created alike
+      NodeMetadataPtr metadata;
+
+      // allocated the first time the bounds are computed
+      std::unique_ptr<BoundsCache> boundsCache;
+
       Any value;
-      // vectors allows using length to determine if min/max is set
-      std::vector<Any> minMax;
 
+      ChildMap children;
+      ParentList parents;
+      // children whose subtree was modified since this node was committed
+      std::unordered_set<Node *> dirtyChildren;
+
+      TimeStamp whenCreated;
+      TimeStamp lastModified;
+      TimeStamp childrenMTime;
+      TimeStamp lastCommitted;
+
+      // modification epoch in which parents were last notified through here
+      size_t modifiedEpoch{0};
+
+      // Small members are kept together to avoid padding //
+
+      NodeType type;
       // prevent user adjustment to this Node *via the UI*
       bool readOnly;
       // Nodes that are used internally to the SG and invalid for OSPRay
       bool sgOnly{false};
       // Nodes that should not be shown in the UI 
       bool sgNoUI{false};
-
-      FlatMap<std::string, NodePtr> children;
-      std::vector<Node *> parents;
-
-      TimeStamp whenCreated;
-      TimeStamp lastModified;
-      TimeStamp childrenMTime;
-      TimeStamp lastCommitted;
-      TimeStamp lastVerified;
+      // parents still need to be notified when the transaction ends
+      bool propagationPending{false};
+      // entry in the SearchIndex, 0 if not indexed. Written by the index,
+      // read by structural changes on any thread.
+      std::atomic<uint32_t> searchId{0};
+
+      // guards children, parents, dirtyChildren, the modification epoch and
+      // the bounds cache.
+      // Locks are only nested upwards (child, then parent) while notifying
+      // parents of a modification.
+      SpinLock structureLock;
     } properties;
 
+    void setDescription(std::string description);
+
     void removeFromParentList(Node &node);
+    void eraseParent(Node &node);
+
+    std::unordered_set<Node *> takeDirtyChildren();
+
+    using CloneMap = std::unordered_map<const Node *, NodePtr>;
+    void copyInto(Node &copy, CloneMode mode, CloneMap &copies) const;
+
+    static void flushTransaction();
 
     friend NodePtr OSPSG_INTERFACE createNode(std::string, std::string, std::string, Any);
+    friend std::vector<NodePtr> OSPSG_INTERFACE createNodes(size_t,
+                                                            const std::string &,
+                                                            const std::string &);
 
     friend struct CommitVisitor;
+    friend class SearchIndex;
   };
 
-  // SG Instance Picking //////////////////////////////////////////////////////
+  // Scoped modification transaction ////////////////////////////////////////
 
-  typedef std::unordered_map<OSPInstance, unsigned int> OSPInstanceSGIdMap;
-  typedef std::unordered_map<OSPGeometricModel, unsigned int>
-      OSPGeomModelSGIdMap;
+  // RAII helper for Node::beginTransaction()/endTransaction(), used to batch
+  // the many setValue() calls made by importers and scene file loading.
+  struct ModificationTransaction
+  {
+    ModificationTransaction()
+    {
+      Node::beginTransaction();
+    }
+
+    ~ModificationTransaction()
+    {
+      Node::endTransaction();
+    }
+
+    ModificationTransaction(const ModificationTransaction &) = delete;
+    ModificationTransaction &operator=(const ModificationTransaction &) = delete;
+  };
 
   /////////////////////////////////////////////////////////////////////////////
   // Nodes with a strongly-typed value ////////////////////////////////////////
   /////////////////////////////////////////////////////////////////////////////
 
+  // Values which Node_T<> keeps inline, next to the node, instead of in a
+  // heap allocated Any
+  template <typename T>
+  struct is_inline_value
+      : std::integral_constant<bool,
+            std::is_trivially_destructible<T>::value
+                && std::is_default_constructible<T>::value
+                && sizeof(T) <= 64>
+  {};
+
+  template <typename T, bool INLINE = is_inline_value<T>::value>
+  struct InlineValueStorage
+  {
+    T *ptr() const
+    {
+      return nullptr;
+    }
+  };
+
+  template <typename T>
+  struct InlineValueStorage<T, true>
+  {
+    T *ptr() const
+    {
+      return const_cast<T *>(&value);
+    }
+
+    T value{};
+  };
+
   template <typename VALUE_T>
   struct Node_T : public Node
   {
-    Node_T()                   = default;
+    Node_T();
     virtual ~Node_T() override = default;
 
     NodeType type() const override;
 
+    // Typed accessor, reads the inline value without going through Any
     const VALUE_T &value() const;
 
     template <typename OT>
@@ -323,6 +518,12 @@ namespace sg {
 
    protected:
     void setOSPRayParam(std::string param, OSPObject obj) override;
+
+    bool assignInlineValue(const Any &val, bool &changed) override;
+    Any inlineValueAsAny() const override;
+
+   private:
+    InlineValueStorage<VALUE_T> storage;
   };
 
   // Pre-defined parameter nodes //////////////////////////////////////////////
@@ -408,6 +609,10 @@ namespace sg {
     virtual void postCommit() override;
 
     void setOSPRayParam(std::string param, OSPObject obj) override;
+
+    // Each copy keeps the OSPRay object created by its constructor, which
+    // gets its parameters from the cloned children on commit
+    void cloneValueFrom(const Node &source) override;
   };
 
   /////////////////////////////////////////////////////////////////////////////
@@ -427,6 +632,12 @@ namespace sg {
                                      std::string subtype,
                                      Any value);
 
+  // Bulk creation of 'count' nodes of the same subtype, named
+  // "<baseName>_<i>". Prefer this over createNode() in a loop when an
+  // importer generates many nodes at once.
+  OSPSG_INTERFACE std::vector<NodePtr> createNodes(
+      size_t count, const std::string &subtype, const std::string &baseName);
+
   template <typename NODE_T, typename... Args>
   inline std::shared_ptr<NODE_T> createNodeAs(Args &&... args)
   {
@@ -438,11 +649,37 @@ namespace sg {
   // Node factory function registration ///////////////////////////////////////
   /////////////////////////////////////////////////////////////////////////////
 
+  using NodeCreatorFct       = Node *(*)();
+  using PooledNodeCreatorFct = void (*)(NodePool *, NodePtr *);
+
+  // Static instances created by OSP_REGISTER_SG_NODE_NAME add their node type
+  // to the factory registry when the library or plugin is loaded, lookups in
+  // createNode() are then lock free and never search library symbols.
+  struct OSPSG_INTERFACE NodeRegistrar
+  {
+    NodeRegistrar(const char *subtype,
+        NodeCreatorFct creator,
+        PooledNodeCreatorFct pooledCreator);
+  };
+
+  // All node subtypes registered by the loaded libraries, sorted
+  OSPSG_INTERFACE std::vector<std::string> registeredNodeTypes();
+
 #define OSP_REGISTER_SG_NODE_NAME(InternalClassName, Name)                     \
   extern "C" OSPSG_DLLEXPORT ospray::sg::Node *ospray_create_sg_node__##Name() \
   {                                                                            \
     return new InternalClassName;                                              \
   }                                                                            \
+  extern "C" OSPSG_DLLEXPORT void ospray_create_pooled_sg_node__##Name(        \
+      ospray::sg::NodePool *pool, ospray::sg::NodePtr *node)                   \
+  {                                                                            \
+    *node = std::allocate_shared<InternalClassName>(                           \
+        ospray::sg::PoolAllocator<InternalClassName>(pool));                   \
+  }                                                                            \
+  static ospray::sg::NodeRegistrar ospray_sg_node_registrar__##Name(           \
+      #Name,                                                                   \
+      ospray_create_sg_node__##Name,                                           \
+      ospray_create_pooled_sg_node__##Name);                                   \
   /* Extra declaration to avoid "extra ;" pedantic warnings */                 \
   ospray::sg::Node *ospray_create_sg_node__##Name()
 
@@ -5,6 +5,11 @@
 
 #include "Data.h"
 #include <json.hpp>
+#include "rkcommon/tasking/parallel_for.h"
+// stl
+#include <algorithm>
+#include <cstring>
+#include <thread>
 
 namespace ospray {
   namespace sg {
@@ -55,11 +60,17 @@ namespace ospray {
   template <>
   inline void Node::setValue(Any val, bool markModified)
   {
-    if (val != properties.value) {
-      properties.value = val;
-      if (markModified)
-        markAsModified();
+    bool changed = false;
+    if (!inlineValue || !assignInlineValue(val, changed)) {
+      // Value type doesn't fit the inline storage, keep it in the Any
+      changed = inlineValueType || val != properties.value;
+      inlineValueType = nullptr;
+      if (changed)
+        properties.value = val;
     }
+
+    if (changed && markModified)
+      markAsModified();
   }
 
   template <typename T>
@@ -71,7 +82,9 @@ namespace ospray {
   template <typename T>
   inline T &Node::valueAs()
   {
-    if (!properties.value.valid()) {
+    if (auto *inlined = inlineValuePtr<T>())
+      return *inlined;
+    if (!inlineValueType && !properties.value.valid()) {
       std::stringstream msg;
       msg << "Node::valueAs() can't query value from an empty Any\n";
       msg << "  Node::name() = " << name() << "\n";
@@ -79,7 +92,7 @@ namespace ospray {
       msg << "  Node::subType() = " << subType() << "\n";
       throw std::runtime_error(msg.str());
     }
-    if (!properties.value.is<T>()) {
+    if (inlineValueType || !properties.value.is<T>()) {
       std::stringstream msg;
       msg << "Node::valueAs(): Incorrect type queried for Any\n";
       msg << "  Node::name() = " << name() << "\n";
@@ -95,7 +108,9 @@ namespace ospray {
   template <typename T>
   inline const T &Node::valueAs() const
   {
-    if (!properties.value.valid()) {
+    if (auto *inlined = inlineValuePtr<T>())
+      return *inlined;
+    if (!inlineValueType && !properties.value.valid()) {
       std::stringstream msg;
       msg << "Node::valueAs(): Can't query value from an empty Any\n";
       msg << "  Node::name() = " << name() << "\n";
@@ -103,7 +118,7 @@ namespace ospray {
       msg << "  Node::subType() = " << subType() << "\n";
       throw std::runtime_error(msg.str());
     }
-    if (!properties.value.is<T>()) {
+    if (inlineValueType || !properties.value.is<T>()) {
       std::stringstream msg;
       msg << "Node::valueAs(): Incorrect type queried for Any\n";
       msg << "  Node::name() = " << name() << "\n";
@@ -119,9 +134,19 @@ namespace ospray {
   template <typename T>
   inline bool Node::valueIsType() const
   {
+    if (inlineValueType)
+      return *inlineValueType == typeid(T);
     return properties.value.is<T>();
   }
 
+  template <typename T>
+  inline T *Node::inlineValuePtr() const
+  {
+    if (inlineValueType && *inlineValueType == typeid(T))
+      return static_cast<T *>(inlineValue);
+    return nullptr;
+  }
+
   inline void Node::operator=(Any v)
   {
     setValue(v);
@@ -201,16 +226,93 @@ namespace ospray {
     visitor.postChildren(*this, ctx);
   }
 
+  template <typename VISITOR_T>
+  inline void Node::traverseParallel(VISITOR_T &&visitor)
+  {
+    TraversalContext ctx;
+    ctx.name = "<root>";
+    traverseParallel(visitor, ctx);
+  }
+
+  template <typename VISITOR_T, typename... Args>
+  inline void Node::traverseParallel(Args &&... args)
+  {
+    traverseParallel(VISITOR_T(std::forward<Args>(args)...));
+  }
+
+  template <typename VISITOR_T>
+  inline void Node::traverseParallel(VISITOR_T &visitor, TraversalContext &ctx)
+  {
+    static_assert(is_valid_visitor<VISITOR_T>::value,
+        "VISITOR_T must be a child class of sg::Visitor or"
+        " implement 'bool visit(Node &node, TraversalContext &ctx)'"
+        "!");
+
+    // Below this many children splitting costs more than it gains
+    constexpr size_t minParallelChildren = 16;
+
+    if (visitor(*this, ctx)) {
+      auto &children = properties.children;
+      const size_t numChildren = children.size();
+
+      if (numChildren < minParallelChildren) {
+        ctx.level++;
+        std::string oldName = ctx.name;
+
+        for (auto &child : children) {
+          ctx.name = child.first;
+          child.second->traverseParallel(visitor, ctx);
+        }
+
+        ctx.name = oldName;
+        ctx.level--;
+      } else {
+        std::vector<const ChildMap::item_t *> items;
+        items.reserve(numChildren);
+        for (auto &child : children)
+          items.push_back(&child);
+
+        // A few tasks per thread for load balancing, each with a single
+        // task-local visitor for a contiguous range of children
+        static const size_t maxTasks =
+            4 * std::max(1u, std::thread::hardware_concurrency());
+        const size_t numTasks = std::min(numChildren, maxTasks);
+
+        std::vector<std::unique_ptr<VISITOR_T>> taskVisitors(numTasks);
+
+        tasking::parallel_for(numTasks, [&](size_t task) {
+          taskVisitors[task].reset(new VISITOR_T(visitor, ParallelSplit()));
+
+          TraversalContext taskCtx;
+          taskCtx.level = ctx.level + 1;
+
+          const size_t begin = task * numChildren / numTasks;
+          const size_t end   = (task + 1) * numChildren / numTasks;
+          for (size_t i = begin; i < end; ++i) {
+            taskCtx.name = items[i]->first;
+            items[i]->second->traverseParallel(*taskVisitors[task], taskCtx);
+          }
+        });
+
+        // Merge in child order to match the sequential traversal
+        for (auto &taskVisitor : taskVisitors)
+          visitor.reduce(*taskVisitor);
+      }
+    }
+
+    visitor.postChildren(*this, ctx);
+  }
+
   template <typename T>
   inline const T &Node::minAs() const
   {
-    return properties.minMax[0].get<T>();
+    return properties.metadata->minMax[0].get<T>();
   }
 
   template <typename T>
   inline const T &Node::maxAs() const
   {
-    return properties.minMax[1].get<T>();
+    return properties.metadata->minMax[1].get<T>();
   }
 
   inline bool Node::subtreeModifiedButNotCommitted() const
@@ -239,12 +341,49 @@ namespace ospray {
     return NodeType::PARAMETER;
   }
 
+  template <typename VALUE_T>
+  inline Node_T<VALUE_T>::Node_T()
+  {
+    inlineValue = storage.ptr();
+  }
+
   template <typename VALUE_T>
   inline const VALUE_T &Node_T<VALUE_T>::value() const
   {
+    // inlineValueType can only ever be VALUE_T here
+    if (inlineValueType)
+      return *storage.ptr();
     return Node::valueAs<VALUE_T>();
   }
 
+  template <typename VALUE_T>
+  inline bool Node_T<VALUE_T>::assignInlineValue(const Any &val, bool &changed)
+  {
+    auto *inlined = storage.ptr();
+    if (!inlined || !val.is<VALUE_T>())
+      return false;
+
+    // Inline values are plain bytes, compare them as such
+    const VALUE_T &v = val.get<VALUE_T>();
+    changed = !inlineValueType || std::memcmp(inlined, &v, sizeof(VALUE_T));
+    if (changed)
+      *inlined = v;
+
+    if (!inlineValueType) {
+      inlineValueType = &typeid(VALUE_T);
+      properties.value = Any();
+    }
+
+    return true;
+  }
+
+  template <typename VALUE_T>
+  inline Any Node_T<VALUE_T>::inlineValueAsAny() const
+  {
+    auto *inlined = storage.ptr();
+    return inlined ? Any(*inlined) : Any();
+  }
+
   template <typename VALUE_T>
   template <typename OT>
   inline void Node_T<VALUE_T>::operator=(OT &&val)
@@ -326,6 +465,11 @@ namespace ospray {
     handle().commit();
   }
 
+  template <typename HANDLE_T, NodeType TYPE>
+  inline void OSPNode<HANDLE_T, TYPE>::cloneValueFrom(const Node &)
+  {
+  }
+
   template <typename HANDLE_T, NodeType TYPE>
   inline void OSPNode<HANDLE_T, TYPE>::setOSPRayParam(std::string param,
                                                       OSPObject obj)
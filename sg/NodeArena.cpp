@@ -0,0 +1,345 @@
+// Copyright 2009 Intel Corporation
+// SPDX-License-Identifier: Apache-2.0
+
+#include "NodeArena.h"
+// stl
+#include <algorithm>
+#include <functional>
+#include <map>
+#include <new>
+
+namespace ospray {
+namespace sg {
+
+///////////////////////////////////////////////////////////////////////////////
+// NodePool ///////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+namespace {
+constexpr size_t blockAlignment = alignof(std::max_align_t);
+constexpr size_t maxSlabBlocks = 4096;
+// blocks moved between a thread's cache and the slabs at once
+constexpr size_t cacheBatch = 32;
+
+size_t roundUpToAlignment(size_t bytes)
+{
+  bytes = std::max(bytes, sizeof(void *));
+  return (bytes + blockAlignment - 1) / blockAlignment * blockAlignment;
+}
+
+size_t nextCacheId()
+{
+  static std::atomic<size_t> numPools{0};
+  return numPools++;
+}
+
+// Set once this thread's cache is gone, nodes released by later thread_local
+// destructors then go straight to the slabs
+thread_local bool threadCacheDestroyed = false;
+} // namespace
+
+struct NodePool::Slab
+{
+  char *begin;
+  size_t numBlocks;
+  size_t numFree;
+  FreeBlock *freeList{nullptr};
+  bool isAvailable{false};
+};
+
+struct NodePool::ThreadCache
+{
+  struct Entry
+  {
+    NodePool *pool{nullptr};
+    FreeBlock *blocks{nullptr};
+    size_t count{0};
+  };
+
+  ~ThreadCache()
+  {
+    threadCacheDestroyed = true;
+    for (auto &e : entries) {
+      if (!e.blocks)
+        continue;
+      std::lock_guard<std::mutex> lock(e.pool->mutex);
+      e.pool->returnBlocks(e.blocks);
+    }
+  }
+
+  Entry &entry(NodePool &pool)
+  {
+    if (pool.cacheId >= entries.size())
+      entries.resize(pool.cacheId + 1);
+    auto &e = entries[pool.cacheId];
+    e.pool = &pool;
+    return e;
+  }
+
+  std::vector<Entry> entries;
+};
+
+NodePool::ThreadCache &NodePool::threadCache()
+{
+  thread_local ThreadCache cache;
+  return cache;
+}
+
+NodePool::NodePool(const std::string &subtype)
+    : poolSubtype(subtype), cacheId(nextCacheId())
+{}
+
+NodePool::~NodePool()
+{
+  // Only this thread's cache can be reached, pools used by other threads
+  // have to outlive them
+  if (!threadCacheDestroyed) {
+    auto &e = threadCache().entry(*this);
+    e.blocks = nullptr;
+    e.count = 0;
+  }
+
+  for (auto *slab : slabs) {
+    ::operator delete(slab->begin);
+    delete slab;
+  }
+}
+
+void *NodePool::allocate(size_t bytes)
+{
+  const size_t blockBytes = roundUpToAlignment(bytes);
+  size_t size = bytesPerBlock.load();
+  if (size == 0) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (bytesPerBlock == 0)
+      bytesPerBlock = blockBytes;
+    size = bytesPerBlock;
+  }
+
+  // A request of an unexpected size (e.g. a different standard library
+  // allocating more than one object) is served by the heap
+  if (blockBytes != size)
+    return ::operator new(bytes);
+
+  allocated++;
+
+  if (threadCacheDestroyed) {
+    std::lock_guard<std::mutex> lock(mutex);
+    size_t taken;
+    return takeBlocks(1, taken);
+  }
+
+  auto &cache = threadCache().entry(*this);
+  if (!cache.blocks) {
+    std::lock_guard<std::mutex> lock(mutex);
+    cache.blocks = takeBlocks(cacheBatch, cache.count);
+  }
+
+  auto *block = cache.blocks;
+  cache.blocks = block->next;
+  cache.count--;
+  return block;
+}
+
+void NodePool::deallocate(void *ptr, size_t bytes)
+{
+  if (!ptr)
+    return;
+
+  if (roundUpToAlignment(bytes) != bytesPerBlock.load()) {
+    ::operator delete(ptr);
+    return;
+  }
+
+  allocated--;
+
+  auto *block = static_cast<FreeBlock *>(ptr);
+
+  if (threadCacheDestroyed) {
+    std::lock_guard<std::mutex> lock(mutex);
+    block->next = nullptr;
+    returnBlocks(block);
+    return;
+  }
+
+  auto &cache = threadCache().entry(*this);
+  block->next = cache.blocks;
+  cache.blocks = block;
+  cache.count++;
+
+  // Keep the most recently freed blocks, hand the others back to the slabs
+  if (cache.count > 2 * cacheBatch) {
+    auto *last = cache.blocks;
+    for (size_t i = 1; i < cacheBatch; ++i)
+      last = last->next;
+    auto *rest = last->next;
+    last->next = nullptr;
+    cache.count = cacheBatch;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    returnBlocks(rest);
+  }
+}
+
+void NodePool::reserve(size_t count)
+{
+  std::lock_guard<std::mutex> lock(mutex);
+
+  // Block size isn't known before the first allocation, growth of the slab
+  // size is then all we can do
+  if (bytesPerBlock == 0) {
+    nextSlabBlocks = std::max(nextSlabBlocks, std::min(count, maxSlabBlocks));
+    return;
+  }
+
+  // Bounded slabs, so that each can be released once its own nodes are
+  while (numFree < count)
+    addSlab(std::min(count - numFree, maxSlabBlocks));
+}
+
+size_t NodePool::blockSize() const
+{
+  return bytesPerBlock;
+}
+
+size_t NodePool::numSlabs() const
+{
+  std::lock_guard<std::mutex> lock(mutex);
+  return slabs.size();
+}
+
+size_t NodePool::numAllocated() const
+{
+  return allocated;
+}
+
+NodePool::Slab *NodePool::addSlab(size_t numBlocks)
+{
+  auto *slab = new Slab;
+  slab->begin =
+      static_cast<char *>(::operator new(numBlocks * bytesPerBlock));
+  slab->numBlocks = numBlocks;
+  slab->numFree = numBlocks;
+
+  // Thread the new blocks onto the free list in address order
+  for (size_t i = numBlocks; i-- > 0;) {
+    auto *block =
+        reinterpret_cast<FreeBlock *>(slab->begin + i * bytesPerBlock);
+    block->next = slab->freeList;
+    slab->freeList = block;
+  }
+
+  auto pos = std::upper_bound(
+      slabs.begin(), slabs.end(), slab, [](const Slab *a, const Slab *b) {
+        return std::less<const char *>()(a->begin, b->begin);
+      });
+  slabs.insert(pos, slab);
+
+  slab->isAvailable = true;
+  available.push_back(slab);
+  numFree += numBlocks;
+  return slab;
+}
+
+void NodePool::releaseSlab(Slab *slab)
+{
+  if (slab->isAvailable)
+    available.erase(std::find(available.begin(), available.end(), slab));
+  slabs.erase(std::find(slabs.begin(), slabs.end(), slab));
+  numFree -= slab->numBlocks;
+
+  ::operator delete(slab->begin);
+  delete slab;
+}
+
+NodePool::Slab *NodePool::slabOf(void *block) const
+{
+  // Last slab starting at or before the block
+  auto *address = static_cast<const char *>(block);
+  auto itr = std::upper_bound(
+      slabs.begin(), slabs.end(), address, [](const char *a, const Slab *s) {
+        return std::less<const char *>()(a, s->begin);
+      });
+  return *(itr - 1);
+}
+
+NodePool::FreeBlock *NodePool::takeBlocks(size_t count, size_t &taken)
+{
+  FreeBlock *blocks = nullptr;
+  taken = 0;
+
+  while (taken < count) {
+    if (available.empty()) {
+      if (taken)
+        break;
+      addSlab(nextSlabBlocks);
+      nextSlabBlocks = std::min(nextSlabBlocks * 2, maxSlabBlocks);
+    }
+
+    auto *slab = available.back();
+    while (slab->freeList && taken < count) {
+      auto *block = slab->freeList;
+      slab->freeList = block->next;
+      block->next = blocks;
+      blocks = block;
+      slab->numFree--;
+      taken++;
+    }
+
+    if (slab == spare)
+      spare = nullptr;
+    if (!slab->freeList) {
+      slab->isAvailable = false;
+      available.pop_back();
+    }
+  }
+
+  numFree -= taken;
+  return blocks;
+}
+
+void NodePool::returnBlocks(FreeBlock *blocks)
+{
+  while (blocks) {
+    auto *block = blocks;
+    blocks = block->next;
+
+    auto *slab = slabOf(block);
+    block->next = slab->freeList;
+    slab->freeList = block;
+    slab->numFree++;
+    numFree++;
+
+    if (!slab->isAvailable) {
+      slab->isAvailable = true;
+      available.push_back(slab);
+    }
+
+    if (slab->numFree == slab->numBlocks) {
+      if (!spare)
+        spare = slab;
+      else
+        releaseSlab(slab);
+    }
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Pool registry //////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+NodePool *getNodePool(const std::string &subtype)
+{
+  static std::mutex mutex;
+  // never destroyed, see header
+  static auto *pools = new std::map<std::string, NodePool *>;
+
+  std::lock_guard<std::mutex> lock(mutex);
+  auto &pool = (*pools)[subtype];
+  if (!pool)
+    pool = new NodePool(subtype);
+  return pool;
+}
+
+} // namespace sg
+} // namespace ospray
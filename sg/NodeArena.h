@@ -0,0 +1,150 @@
+// Copyright 2009 Intel Corporation
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+// stl
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#ifndef OSPSG_INTERFACE
+#ifdef _WIN32
+#ifdef ospray_sg_EXPORTS
+#define OSPSG_INTERFACE __declspec(dllexport)
+#else
+#define OSPSG_INTERFACE __declspec(dllimport)
+#endif
+#define OSPSG_DLLEXPORT __declspec(dllexport)
+#else
+#define OSPSG_INTERFACE
+#define OSPSG_DLLEXPORT
+#endif
+#endif
+
+namespace ospray {
+namespace sg {
+
+///////////////////////////////////////////////////////////////////////////////
+// Node pools /////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+// Fixed size block allocator used for all nodes of one subtype. Each node
+// and its shared_ptr control block come from a single block (through
+// std::allocate_shared), blocks are carved from larger slabs and recycled
+// through free lists, so creating millions of small parameter nodes neither
+// hits the heap per node nor fragments it.
+//
+// Each thread keeps a small cache of free blocks per pool, exchanged with the
+// shared slabs in batches, so most allocations don't take the pool's mutex.
+// A slab whose blocks are all free again is returned to the heap, except for
+// one spare slab per pool kept against allocate/free cycles at its boundary.
+// Blocks still sitting in a thread's cache keep their slab alive until the
+// thread exits.
+class OSPSG_INTERFACE NodePool
+{
+ public:
+  explicit NodePool(const std::string &subtype);
+  ~NodePool();
+
+  NodePool(const NodePool &) = delete;
+  NodePool &operator=(const NodePool &) = delete;
+
+  void *allocate(size_t bytes);
+  void deallocate(void *ptr, size_t bytes);
+
+  // Make sure the next 'count' allocations don't need a new slab
+  void reserve(size_t count);
+
+  const std::string &subtype() const
+  {
+    return poolSubtype;
+  }
+
+  // Statistics //
+
+  size_t blockSize() const;
+  size_t numSlabs() const;
+  size_t numAllocated() const;
+
+ private:
+  struct FreeBlock
+  {
+    FreeBlock *next;
+  };
+
+  struct Slab;
+  struct ThreadCache;
+
+  static ThreadCache &threadCache();
+
+  // Called with the mutex held
+  Slab *addSlab(size_t numBlocks);
+  void releaseSlab(Slab *slab);
+  Slab *slabOf(void *block) const;
+  FreeBlock *takeBlocks(size_t count, size_t &taken);
+  void returnBlocks(FreeBlock *blocks);
+
+  std::string poolSubtype;
+  // index of this pool's entry in the thread caches
+  size_t cacheId;
+  mutable std::mutex mutex;
+  // set by the first allocation, a pool only ever serves one node type
+  std::atomic<size_t> bytesPerBlock{0};
+  size_t nextSlabBlocks{64};
+  std::atomic<size_t> allocated{0};
+  // sorted by address, to find the slab of a returned block
+  std::vector<Slab *> slabs;
+  // slabs with free blocks
+  std::vector<Slab *> available;
+  Slab *spare{nullptr};
+  size_t numFree{0};
+};
+
+// Pools are never destroyed: nodes may outlive any static object that could
+// own them, and threads return their cached blocks when they exit. Returned
+// pointers are stable.
+OSPSG_INTERFACE NodePool *getNodePool(const std::string &subtype);
+
+// std::allocator compatible adapter used with std::allocate_shared
+template <typename T>
+struct PoolAllocator
+{
+  using value_type = T;
+
+  explicit PoolAllocator(NodePool *_pool) : pool(_pool) {}
+
+  template <typename U>
+  PoolAllocator(const PoolAllocator<U> &other) : pool(other.pool)
+  {}
+
+  T *allocate(size_t n)
+  {
+    return static_cast<T *>(pool->allocate(n * sizeof(T)));
+  }
+
+  void deallocate(T *ptr, size_t n)
+  {
+    pool->deallocate(ptr, n * sizeof(T));
+  }
+
+  template <typename U>
+  bool operator==(const PoolAllocator<U> &other) const
+  {
+    return pool == other.pool;
+  }
+
+  template <typename U>
+  bool operator!=(const PoolAllocator<U> &other) const
+  {
+    return pool != other.pool;
+  }
+
+  NodePool *pool{nullptr};
+};
+
+} // namespace sg
+} // namespace ospray
@@ -0,0 +1,148 @@
+// Copyright 2009 Intel Corporation
+// SPDX-License-Identifier: Apache-2.0
+
+#include "NodeMetadata.h"
+// stl
+#include <algorithm>
+#include <functional>
+#include <mutex>
+#include <unordered_map>
+
+namespace ospray {
+namespace sg {
+
+namespace {
+struct MetadataEntry
+{
+  // valid while the entry is in the table, records leave it before they're
+  // deleted
+  const NodeMetadata *record;
+  std::weak_ptr<const NodeMetadata> ref;
+};
+
+struct MetadataTable
+{
+  std::mutex mutex;
+  // by hash of description and range, equal hashes are told apart by value
+  std::unordered_map<size_t, std::vector<MetadataEntry>> entries;
+};
+
+MetadataTable &metadataTable()
+{
+  // never destroyed, nodes may be released during static destruction
+  static MetadataTable *table = new MetadataTable;
+  return *table;
+}
+
+void hashCombine(size_t &seed, size_t hash)
+{
+  seed ^= hash + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+}
+
+// Ranges are set with plain numbers, other types only share a hash
+size_t hashOf(const rkcommon::utility::Any &value)
+{
+  if (value.is<float>())
+    return std::hash<float>()(value.get<float>());
+  if (value.is<int>())
+    return std::hash<int>()(value.get<int>());
+  if (value.is<uint32_t>())
+    return std::hash<uint32_t>()(value.get<uint32_t>());
+  if (value.is<double>())
+    return std::hash<double>()(value.get<double>());
+  if (value.is<bool>())
+    return std::hash<bool>()(value.get<bool>());
+  return 0;
+}
+
+size_t hashOf(const NodeMetadata &metadata)
+{
+  size_t hash = std::hash<std::string>()(metadata.description);
+  for (auto &value : metadata.minMax)
+    hashCombine(hash, hashOf(value));
+  return hash;
+}
+
+// Takes a record out of the table with its last reference
+struct MetadataDeleter
+{
+  size_t hash;
+
+  void operator()(const NodeMetadata *record) const
+  {
+    {
+      auto &table = metadataTable();
+      std::lock_guard<std::mutex> lock(table.mutex);
+      auto itr = table.entries.find(hash);
+      auto &bucket = itr->second;
+      bucket.erase(std::find_if(bucket.begin(),
+          bucket.end(),
+          [&](const MetadataEntry &e) { return e.record == record; }));
+      if (bucket.empty())
+        table.entries.erase(itr);
+    }
+    delete record;
+  }
+};
+} // namespace
+
+bool NodeMetadata::operator==(const NodeMetadata &o) const
+{
+  if (description != o.description || minMax.size() != o.minMax.size())
+    return false;
+
+  for (size_t i = 0; i < minMax.size(); ++i)
+    if (minMax[i] != o.minMax[i])
+      return false;
+
+  return true;
+}
+
+std::shared_ptr<const NodeMetadata> NodeMetadata::intern(NodeMetadata metadata)
+{
+  // Nodes are mostly created in runs of the same kind, try the last record
+  // this thread interned before taking the lock
+  thread_local std::shared_ptr<const NodeMetadata> last;
+  if (last && *last == metadata)
+    return last;
+
+  const size_t hash = hashOf(metadata);
+  std::shared_ptr<const NodeMetadata> found;
+  {
+    // No reference may be dropped while locked, the deleter takes the lock
+    auto &table = metadataTable();
+    std::lock_guard<std::mutex> lock(table.mutex);
+
+    auto &bucket = table.entries[hash];
+    for (auto &entry : bucket) {
+      // a record released meanwhile fails to lock, it's replaced below
+      if (*entry.record == metadata && (found = entry.ref.lock()))
+        break;
+    }
+
+    if (!found) {
+      auto *record = new NodeMetadata(std::move(metadata));
+      found = std::shared_ptr<const NodeMetadata>(
+          record, MetadataDeleter{hash});
+      bucket.push_back({record, found});
+    }
+  }
+
+  last = found;
+  return found;
+}
+
+size_t NodeMetadata::numInterned()
+{
+  auto &table = metadataTable();
+  std::lock_guard<std::mutex> lock(table.mutex);
+
+  size_t count = 0;
+  for (auto &bucket : table.entries)
+    for (auto &entry : bucket.second)
+      count += !entry.ref.expired();
+  return count;
+}
+
+} // namespace sg
+} // namespace ospray
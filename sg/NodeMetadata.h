@@ -0,0 +1,58 @@
+// Copyright 2009 Intel Corporation
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+// stl
+#include <memory>
+#include <string>
+#include <vector>
+// rkcommon
+#include "rkcommon/utility/Any.h"
+
+#ifndef OSPSG_INTERFACE
+#ifdef _WIN32
+#ifdef ospray_sg_EXPORTS
+#define OSPSG_INTERFACE __declspec(dllexport)
+#else
+#define OSPSG_INTERFACE __declspec(dllimport)
+#endif
+#define OSPSG_DLLEXPORT __declspec(dllexport)
+#else
+#define OSPSG_INTERFACE
+#define OSPSG_DLLEXPORT
+#endif
+#endif
+
+namespace ospray {
+namespace sg {
+
+///////////////////////////////////////////////////////////////////////////////
+// Shared node metadata ///////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+// Descriptive data which is set when a node is created and rarely changes.
+// Importers create most nodes of a subtype from the same few call sites, so
+// the records are interned: all nodes with the same description and range
+// reference one immutable copy.
+struct OSPSG_INTERFACE NodeMetadata
+{
+  std::string description;
+  // vectors allows using length to determine if min/max is set
+  std::vector<rkcommon::utility::Any> minMax;
+
+  bool operator==(const NodeMetadata &o) const;
+
+  // Shared record equal to 'metadata', created if needed. Records are looked
+  // up by a hash of description and range, and leave the table when the
+  // last node referencing them releases them.
+  static std::shared_ptr<const NodeMetadata> intern(NodeMetadata metadata);
+
+  // Number of distinct records currently alive
+  static size_t numInterned();
+};
+
+using NodeMetadataPtr = std::shared_ptr<const NodeMetadata>;
+
+} // namespace sg
+} // namespace ospray
@@ -0,0 +1,162 @@
+// Copyright 2009 Intel Corporation
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+// stl
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+#include <utility>
+
+namespace ospray {
+namespace sg {
+
+struct Node;
+
+///////////////////////////////////////////////////////////////////////////////
+// Node parent list ///////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+// Vector-like list of parent pointers. Almost every node has exactly one
+// parent, which is stored inline without a heap allocation; the list is
+// 16 bytes instead of the 24 of a std::vector.
+class ParentList
+{
+ public:
+  using value_type     = Node *;
+  using iterator       = Node **;
+  using const_iterator = Node *const *;
+
+  ParentList() = default;
+
+  ParentList(const ParentList &o)
+  {
+    *this = o;
+  }
+
+  ParentList &operator=(const ParentList &o)
+  {
+    if (this != &o) {
+      clear();
+      reserve(o.count);
+      std::copy(o.begin(), o.end(), begin());
+      count = o.count;
+    }
+    return *this;
+  }
+
+  ~ParentList()
+  {
+    release();
+  }
+
+  // Element access //
+
+  Node *const &operator[](size_t i) const
+  {
+    return begin()[i];
+  }
+
+  Node *const &front() const
+  {
+    if (empty())
+      throw std::out_of_range("ParentList::front(): node has no parents");
+    return *begin();
+  }
+
+  // Iterators //
+
+  iterator begin()
+  {
+    return capacity > 1 ? storage.heap : &storage.single;
+  }
+
+  iterator end()
+  {
+    return begin() + count;
+  }
+
+  const_iterator begin() const
+  {
+    return capacity > 1 ? storage.heap : &storage.single;
+  }
+
+  const_iterator end() const
+  {
+    return begin() + count;
+  }
+
+  // Capacity //
+
+  bool empty() const
+  {
+    return count == 0;
+  }
+
+  size_t size() const
+  {
+    return count;
+  }
+
+  // Modifiers //
+
+  void push_back(Node *parent)
+  {
+    if (count == capacity)
+      reserve(capacity * 2);
+    begin()[count++] = parent;
+  }
+
+  iterator erase(iterator pos)
+  {
+    std::copy(pos + 1, end(), pos);
+    count--;
+    return pos;
+  }
+
+  void clear()
+  {
+    count = 0;
+  }
+
+  void swap(ParentList &o)
+  {
+    std::swap(storage, o.storage);
+    std::swap(count, o.count);
+    std::swap(capacity, o.capacity);
+  }
+
+ private:
+  void reserve(uint32_t newCapacity)
+  {
+    if (newCapacity <= capacity)
+      return;
+
+    auto **heap = new Node *[newCapacity];
+    std::copy(begin(), end(), heap);
+    release();
+    storage.heap = heap;
+    capacity     = newCapacity;
+  }
+
+  void release()
+  {
+    if (capacity > 1)
+      delete[] storage.heap;
+    storage.single = nullptr;
+    capacity       = 1;
+  }
+
+  union
+  {
+    Node *single;
+    Node **heap;
+  } storage{nullptr};
+
+  uint32_t count{0};
+  uint32_t capacity{1};
+};
+
+} // namespace sg
+} // namespace ospray
@@ -2,12 +2,110 @@
 // SPDX-License-Identifier: Apache-2.0
 
 #include "Scheduler.h"
+#include "SchedulerTrace.h"
+// stl
+#include <algorithm>
 
 namespace ospray {
 namespace sg {
 namespace scheduler {
 
 
+// The pool and index of the worker running on this thread, if any
+static thread_local ThreadPool *currentPool{nullptr};
+static thread_local size_t currentWorker{0};
+
+static std::atomic<uint64_t> nextTaskId{0};
+
+ThreadPool::ThreadPool(size_t numThreads) {
+  numThreads = std::max<size_t>(numThreads, 1);
+
+  for (size_t i = 0; i < numThreads; ++i) {
+    workers.emplace_back(new Worker);
+  }
+
+  for (size_t i = 0; i < numThreads; ++i) {
+    threads.emplace_back(&ThreadPool::run, this, i);
+  }
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    std::lock_guard<std::mutex> lock(sleepMutex);
+    stopping = true;
+  }
+  wakeUp.notify_all();
+
+  for (auto &t : threads) {
+    t.join();
+  }
+}
+
+void ThreadPool::submit(std::function<void()> work) {
+  const size_t index = currentPool == this
+                           ? currentWorker
+                           : nextWorker++ % workers.size();
+
+  {
+    std::lock_guard<std::mutex> lock(workers[index]->mutex);
+    workers[index]->queue.push_back(std::move(work));
+  }
+  ++numQueued;
+
+  // taking the lock orders this after a worker's check for queued work, so
+  // a worker about to sleep doesn't miss the notification
+  { std::lock_guard<std::mutex> lock(sleepMutex); }
+  wakeUp.notify_one();
+}
+
+bool ThreadPool::take(size_t index, std::function<void()> &work) {
+  // own work, newest first
+  {
+    Worker &own = *workers[index];
+    std::lock_guard<std::mutex> lock(own.mutex);
+    if (!own.queue.empty()) {
+      work = std::move(own.queue.back());
+      own.queue.pop_back();
+      return true;
+    }
+  }
+
+  // somebody else's, oldest first
+  for (size_t i = 1; i < workers.size(); ++i) {
+    Worker &victim = *workers[(index + i) % workers.size()];
+    std::lock_guard<std::mutex> lock(victim.mutex);
+    if (!victim.queue.empty()) {
+      work = std::move(victim.queue.front());
+      victim.queue.pop_front();
+      return true;
+    }
+  }
+
+  return false;
+}
+
+void ThreadPool::run(size_t index) {
+  currentPool = this;
+  currentWorker = index;
+
+  for (;;) {
+    std::function<void()> work;
+    if (take(index, work)) {
+      --numQueued;
+      work();
+      continue;
+    }
+
+    // queued work is run before stopping
+    std::unique_lock<std::mutex> lock(sleepMutex);
+    wakeUp.wait(lock, [&]() { return numQueued > 0 || stopping; });
+    if (stopping && numQueued == 0) {
+      return;
+    }
+  }
+}
+
+
 SchedulerPtr Scheduler::create() {
   SchedulerPtr scheduler = std::make_shared<Scheduler>(key{});
 
@@ -44,6 +142,41 @@ InstancePtr Scheduler::lookup(const std::string &name) {
   return instance;
 }
 
+void Scheduler::setConcurrency(size_t numThreads) {
+  std::shared_ptr<ThreadPool> oldPool;
+
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    this->numThreads = numThreads;
+    if (threadPool && threadPool->numThreads() != concurrencyLocked()) {
+      oldPool = std::move(threadPool);
+    }
+  }
+
+  // joins the old pool once its queued tasks ran
+  oldPool.reset();
+}
+
+size_t Scheduler::concurrency() {
+  std::lock_guard<std::mutex> lock(mutex);
+  return concurrencyLocked();
+}
+
+std::shared_ptr<ThreadPool> Scheduler::pool() {
+  std::lock_guard<std::mutex> lock(mutex);
+  if (!threadPool) {
+    threadPool = std::make_shared<ThreadPool>(concurrencyLocked());
+  }
+  return threadPool;
+}
+
+size_t Scheduler::concurrencyLocked() const {
+  if (numThreads > 0) {
+    return numThreads;
+  }
+  return std::max<size_t>(std::thread::hardware_concurrency(), 1);
+}
+
 InstancePtr Scheduler::lookupById(size_t id) const {
   auto it = idToInstance.find(id);
   if (it == idToInstance.end()) {
@@ -75,33 +208,85 @@ InstancePtr Scheduler::addByName(const std::string &name) {
 }
 
 
-void Instance::push(const Function &fcn) {
-  push("<unnamed task>", fcn);
+bool Instance::ByPriority::operator()(
+    const TaskPtr &a, const TaskPtr &b) const {
+  // true if 'a' runs after 'b'
+  if (a->priority != b->priority) {
+    return a->priority < b->priority;
+  }
+  return a->sequence > b->sequence;
 }
 
-void Instance::push(const std::string &name, const Function &fcn) {
-  std::fprintf(stderr, "Scheduler(%s): schedule new task with name: %s\n",
-               this->name.c_str(), name.c_str());
+TaskPtr Instance::push(const Function &fcn) {
+  return push("<unnamed task>", fcn);
+}
 
-  std::lock_guard<std::mutex> lock(mutex);
-  TaskPtr task = std::make_shared<Task>(shared_from_this(), name, std::make_shared<Function>(fcn));
-  tasks.emplace(task);
+TaskPtr Instance::push(const std::string &name, const Function &fcn) {
+  return push(name, fcn, TaskOptions{});
 }
 
-TaskPtr Instance::pop() {
-  TaskPtr task{nullptr};
+TaskPtr Instance::push(const std::string &name,
+    const Function &fcn,
+    const TaskOptions &options) {
+  size_t sequence = 0;
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    sequence = nextSequence++;
+  }
+
+  TaskPtr task = std::make_shared<Task>(shared_from_this(), name,
+      std::make_shared<Function>(fcn), options, sequence, nextTaskId++);
+
+  bool dependenciesOk = true;
+  for (const TaskPtr &dependency : options.dependencies) {
+    dependenciesOk = task->addDependency(dependency) && dependenciesOk;
+  }
+
+  if (dependenciesOk) {
+    task->dependencyDone(true);
+  } else {
+    task->cancel();
+  }
+
+  return task;
+}
 
+void Instance::enqueue(const TaskPtr &task) {
+  size_t queueDepth = 0;
   {
     std::lock_guard<std::mutex> lock(mutex);
-    if (tasks.empty()) {
-      return nullptr;
-    }
-    task = tasks.front();
-    tasks.pop();
+    tasks.push(task);
+    queueDepth = tasks.size();
   }
 
-  std::fprintf(stderr, "Scheduler(%s): pulled task with name: %s\n",
-               this->name.c_str(), task->name.c_str());
+  Trace::record(TraceEventType::ENQUEUE, name, task->name, task->id,
+      queueDepth);
+}
+
+TaskPtr Instance::pop() {
+  TaskPtr task{nullptr};
+
+  for (;;) {
+    size_t queueDepth = 0;
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      if (tasks.empty()) {
+        return nullptr;
+      }
+      task = tasks.top();
+      tasks.pop();
+      queueDepth = tasks.size();
+    }
+
+    Trace::record(TraceEventType::DEQUEUE, name, task->name, task->id,
+        queueDepth);
+
+    if (!task->cancelled()) {
+      break;
+    }
+
+    task->cancel();
+  }
 
   return task;
 }
@@ -132,67 +317,81 @@ size_t Instance::executeAllTasksAsync(const TaskPtr &first) {
 
   // ensure this object survives through all lambdas
   auto self = shared_from_this();
+  auto pool = scheduler->pool();
 
   for (TaskPtr task = first; task; task = pop()) {
     ++numTasksExecuted;
 
-    // the callback takes the task (task is an std::shared_ptr) by value,
-    // increasing the refcount, and ensuring the object stays alive throughout
-    // the function call
-    auto callback = [task, self]() {
-      try {
-        (*task)();
-
-      } catch (...) {
-        std::lock_guard<std::mutex> lock(self->mutex);
-        self->running.erase(task);
-        throw;
-      }
-      std::lock_guard<std::mutex> lock(self->mutex);
-      self->running.erase(task);
-    };
-
     {
       std::lock_guard<std::mutex> lock(mutex);
-      running.emplace(task);
+      dispatched.push(task);
+      ++numRunning;
     }
 
-    std::thread t(callback);
-    t.detach();
+    // each callback runs the highest priority task dispatched so far rather
+    // than this one, the pool itself doesn't order its work by priority
+    pool->submit([self]() {
+      TaskPtr task{nullptr};
+      {
+        std::lock_guard<std::mutex> lock(self->mutex);
+        task = self->dispatched.top();
+        self->dispatched.pop();
+      }
+
+      std::exception_ptr error{nullptr};
+      try {
+        (*task)();
+      } catch (...) {
+        error = std::current_exception();
+      }
+      self->finished(std::move(error));
+    });
   }
 
   return numTasksExecuted;
 }
 
+void Instance::finished(std::exception_ptr error) {
+  std::lock_guard<std::mutex> lock(mutex);
+  if (error && !firstError) {
+    firstError = std::move(error);
+  }
+  error = nullptr;
+  if (--numRunning == 0) {
+    allFinished.notify_all();
+  }
+}
+
 size_t Instance::wait() {
-  using namespace std::chrono_literals;
-  size_t numTasksWaited = 0;
+  std::unique_lock<std::mutex> lock(mutex);
+  size_t numTasksWaited = numRunning;
 
-  {
-    std::lock_guard<std::mutex> lock(mutex);
-    numTasksWaited = running.size();
-  }
+  allFinished.wait(lock, [&]() { return numRunning == 0; });
 
-  if (numTasksWaited == 0) {
-    return numTasksWaited;
+  if (firstError) {
+    std::exception_ptr error{nullptr};
+    std::swap(error, firstError);
+    std::rethrow_exception(error);
   }
 
-  for (;;) {
-    {
-      std::lock_guard<std::mutex> lock(mutex);
-      if (running.empty()) {
-        return numTasksWaited;
-      }
-    }
+  return numTasksWaited;
+}
+
 
-    std::this_thread::sleep_for(100ms);
+void Task::operator()() {
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (taskState == TaskState::QUEUED && !(token && token->cancelled())) {
+      taskState = TaskState::RUNNING;
+    }
   }
-}
 
+  if (state() != TaskState::RUNNING) {
+    cancel();
+    return;
+  }
 
-void Task::operator()() const {
-  std::fprintf(stderr, "Scheduler(%s): start task with name: %s\n",
-               instance->name.c_str(), name.c_str());
+  Trace::record(TraceEventType::START, instance->name, name, id);
 
   try {
     fcn->operator()(instance->scheduler);
@@ -200,11 +399,92 @@ void Task::operator()() const {
     std::fprintf(stderr, "Scheduler(%s): got exception in task with name: %s\n",
                  instance->name.c_str(), name.c_str());
 
+    Trace::record(TraceEventType::FAIL, instance->name, name, id);
+    finish(TaskState::FAILED);
     throw;
   }
 
-  std::fprintf(stderr, "Scheduler(%s): finished task with name: %s\n",
-               instance->name.c_str(), name.c_str());
+  Trace::record(TraceEventType::FINISH, instance->name, name, id);
+  finish(TaskState::FINISHED);
+}
+
+void Task::cancel() {
+  std::vector<TaskPtr> cancelledDependents;
+
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (taskState != TaskState::WAITING && taskState != TaskState::QUEUED) {
+      return;
+    }
+    taskState = TaskState::CANCELLED;
+    cancelledDependents.swap(dependents);
+  }
+
+  Trace::record(TraceEventType::CANCEL, instance->name, name, id);
+
+  // a queued task stays in its instance's queue until popped
+  for (auto &dependent : cancelledDependents) {
+    dependent->dependencyDone(false);
+  }
+}
+
+bool Task::cancelled() {
+  return state() == TaskState::CANCELLED || (token && token->cancelled());
+}
+
+TaskState Task::state() {
+  std::lock_guard<std::mutex> lock(mutex);
+  return taskState;
+}
+
+bool Task::addDependency(const TaskPtr &dependency) {
+  std::lock_guard<std::mutex> lock(dependency->mutex);
+  switch (dependency->taskState) {
+  case TaskState::FINISHED:
+    return true;
+  case TaskState::FAILED:
+  case TaskState::CANCELLED:
+    return false;
+  default:
+    ++numPending;
+    dependency->dependents.push_back(shared_from_this());
+    return true;
+  }
+}
+
+void Task::dependencyDone(bool succeeded) {
+  if (!succeeded) {
+    cancel();
+    return;
+  }
+
+  if (--numPending > 0) {
+    return;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (taskState != TaskState::WAITING) {
+      return;
+    }
+    taskState = TaskState::QUEUED;
+  }
+
+  instance->enqueue(shared_from_this());
+}
+
+void Task::finish(TaskState finalState) {
+  std::vector<TaskPtr> released;
+
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    taskState = finalState;
+    released.swap(dependents);
+  }
+
+  for (auto &dependent : released) {
+    dependent->dependencyDone(finalState == TaskState::FINISHED);
+  }
 }
 
 
@@ -4,6 +4,10 @@
 #pragma once
 
 #include <array>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
 #include <memory>
 #include <mutex>
 #include <queue>
@@ -12,6 +16,7 @@
 #include <functional>
 #include <map>
 #include <set>
+#include <vector>
 
 #include "Node.h" // for OSPSG_INTERFACE
 
@@ -32,6 +37,83 @@ using TaskPtr = std::shared_ptr<Task>;
 using Function = std::function<void(SchedulerPtr)>;
 using FunctionPtr = std::shared_ptr<Function>;
 
+class CancellationToken;
+using CancellationTokenPtr = std::shared_ptr<CancellationToken>;
+
+
+// Cancels all tasks pushed with it. Tasks which didn't start yet are skipped,
+// running ones may poll cancelled() to stop early.
+class OSPSG_INTERFACE CancellationToken {
+public:
+  static CancellationTokenPtr create() {
+    return std::make_shared<CancellationToken>();
+  }
+
+  void cancel() {
+    isCancelled = true;
+  }
+
+  bool cancelled() const {
+    return isCancelled;
+  }
+
+private:
+  std::atomic<bool> isCancelled{false};
+};
+
+
+struct TaskOptions {
+  // Ready tasks of higher priority run first, in the order they were pushed
+  // otherwise
+  int priority{0};
+
+  // Tasks which have to finish before this one is queued. If one of them
+  // fails or is cancelled, this one is cancelled as well.
+  std::vector<TaskPtr> dependencies{};
+
+  CancellationTokenPtr token{nullptr};
+};
+
+
+// Fixed number of worker threads, each with its own queue. Workers run their
+// own work newest first and steal the oldest work of the others when they
+// run out, sleeping while there's nothing to do at all.
+class OSPSG_INTERFACE ThreadPool {
+public:
+  explicit ThreadPool(size_t numThreads);
+  // Runs the remaining work, then joins the workers
+  ~ThreadPool();
+  ThreadPool(const ThreadPool &) = delete;
+  ThreadPool &operator=(const ThreadPool &) = delete;
+
+  // Work submitted from a worker goes to its own queue, other work is spread
+  // over the workers
+  void submit(std::function<void()> work);
+
+  size_t numThreads() const {
+    return workers.size();
+  }
+
+private:
+  struct Worker {
+    std::mutex mutex{};
+    std::deque<std::function<void()>> queue{};
+  };
+
+  void run(size_t index);
+  bool take(size_t index, std::function<void()> &work);
+
+  std::vector<std::unique_ptr<Worker>> workers{};
+  std::vector<std::thread> threads{};
+  std::atomic<size_t> nextWorker{0};
+
+  // sleeping workers wait for queued work or the pool to stop
+  std::mutex sleepMutex{};
+  std::condition_variable wakeUp{};
+  std::atomic<size_t> numQueued{0};
+  bool stopping{false};
+};
+
 
 class OSPSG_INTERFACE Scheduler : public std::enable_shared_from_this<Scheduler> {
 protected:
@@ -59,6 +141,16 @@ public:
   InstancePtr lookup(size_t id);
   InstancePtr lookup(const std::string &name);
 
+  // Number of tasks executed concurrently by executeAllTasksAsync(), by
+  // default the number of hardware threads. Changing it once tasks ran
+  // starts a new pool after the old one finished its tasks, so it must not
+  // be called from a task.
+  void setConcurrency(size_t numThreads);
+  size_t concurrency();
+
+  // Workers of executeAllTasksAsync(), started on first use
+  std::shared_ptr<ThreadPool> pool();
+
   InstancePtr ospray() const {
     return osprayInstance;
   }
@@ -75,6 +167,7 @@ private:
   InstancePtr lookupById(size_t id) const;
   InstancePtr lookupByName(const std::string &name) const;
   InstancePtr addByName(const std::string &name);
+  size_t concurrencyLocked() const;
 
   std::mutex mutex{};
   size_t nextId{1};
@@ -84,6 +177,9 @@ private:
   InstancePtr osprayInstance{};
   InstancePtr studioInstance{};
   InstancePtr backgroundInstance{};
+
+  size_t numThreads{0}; // 0: hardware threads
+  std::shared_ptr<ThreadPool> threadPool{};
 };
 
 
@@ -99,13 +195,20 @@ public:
   Instance(const Instance &) = delete;
   Instance &operator=(const Instance &) = delete;
 
-  void push(const Function &fcn);
-  void push(const std::string &name, const Function &fcn);
+  TaskPtr push(const Function &fcn);
+  TaskPtr push(const std::string &name, const Function &fcn);
+  // The task is queued once its dependencies finished
+  TaskPtr push(const std::string &name,
+      const Function &fcn,
+      const TaskOptions &options);
+  // Highest priority task ready to run, cancelled tasks are dropped
   TaskPtr pop();
   size_t executeAllTasksSync();
   size_t executeAllTasksSync(const TaskPtr &first);
   size_t executeAllTasksAsync();
   size_t executeAllTasksAsync(const TaskPtr &first);
+  // Blocks until the tasks started by executeAllTasksAsync() finished and
+  // returns how many were running. Rethrows the first exception of a task.
   size_t wait();
 
   SchedulerPtr scheduler;
@@ -113,31 +216,93 @@ public:
   std::string name;
 
 private:
+  friend class Task;
+
+  struct ByPriority {
+    bool operator()(const TaskPtr &a, const TaskPtr &b) const;
+  };
+  using TaskQueue =
+      std::priority_queue<TaskPtr, std::vector<TaskPtr>, ByPriority>;
+
+  void enqueue(const TaskPtr &task);
+  void finished(std::exception_ptr error);
+
   std::mutex mutex{};
-  std::queue<TaskPtr> tasks{};
-  std::set<TaskPtr> running{};
+  TaskQueue tasks{};
+  size_t nextSequence{0};
+
+  // handed to the pool, which runs them highest priority first whichever
+  // worker gets to them
+  TaskQueue dispatched{};
+  size_t numRunning{0};
+  std::condition_variable allFinished{};
+  std::exception_ptr firstError{};
+};
+
+
+enum class TaskState {
+  WAITING, // for dependencies
+  QUEUED,
+  RUNNING,
+  FINISHED,
+  FAILED,
+  CANCELLED,
 };
 
 
 class OSPSG_INTERFACE Task : public std::enable_shared_from_this<Task> {
 public:
-  Task(InstancePtr _instance, const std::string &_name, FunctionPtr _fcn)
+  Task(InstancePtr _instance,
+      const std::string &_name,
+      FunctionPtr _fcn,
+      const TaskOptions &_options,
+      size_t _sequence,
+      uint64_t _id)
     : instance(_instance)
     , name(_name)
+    , priority(_options.priority)
     , fcn(_fcn)
+    , token(_options.token)
+    , sequence(_sequence)
+    , id(_id)
   {}
 
   ~Task() = default;
   Task(const Task &) = delete;
   Task &operator=(const Task &) = delete;
 
-  void operator()() const;
+  // Runs the task unless it was cancelled, then releases its dependents
+  void operator()();
+
+  // Cancels the task and its dependents, unless it already started
+  void cancel();
+  bool cancelled();
+  TaskState state();
 
   InstancePtr instance;
   std::string name;
+  int priority;
 
 private:
+  friend class Instance;
+
+  // false if 'dependency' failed or was cancelled
+  bool addDependency(const TaskPtr &dependency);
+  void dependencyDone(bool succeeded);
+  void finish(TaskState finalState);
+
   FunctionPtr fcn;
+  CancellationTokenPtr token;
+  // order of pushes to the task's instance
+  size_t sequence;
+  // unique across all instances of all schedulers, names the task in traces
+  uint64_t id;
+
+  std::mutex mutex{};
+  TaskState taskState{TaskState::WAITING};
+  // unfinished dependencies, plus one until push() added them all
+  std::atomic<size_t> numPending{1};
+  std::vector<TaskPtr> dependents{};
 };
 
 
@@ -146,6 +311,9 @@ private:
 
 using Scheduler = scheduler::Scheduler;
 using SchedulerPtr = scheduler::SchedulerPtr;
+using CancellationToken = scheduler::CancellationToken;
+using CancellationTokenPtr = scheduler::CancellationTokenPtr;
+using TaskOptions = scheduler::TaskOptions;
 
 
 } // namespace sg
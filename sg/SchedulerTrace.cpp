@@ -0,0 +1,266 @@
+// Copyright 2009 Intel Corporation
+// SPDX-License-Identifier: Apache-2.0
+
+#include "SchedulerTrace.h"
+// stl
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <mutex>
+
+namespace ospray {
+namespace sg {
+namespace scheduler {
+
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// A slot's sequence is odd while its event is written and 2 * (index + 1)
+// once the event of that index is complete, which tells readers whether the
+// event they copied is the one they wanted and wasn't overwritten meanwhile.
+// The event is stored as atomic words so that readers racing a writer copy
+// torn words rather than race on them.
+constexpr size_t eventWords = sizeof(TraceEvent) / sizeof(uint64_t);
+static_assert(sizeof(TraceEvent) % sizeof(uint64_t) == 0,
+    "TraceEvent has to be stored as whole words");
+
+struct Slot {
+  std::atomic<uint64_t> sequence{0};
+  std::atomic<uint64_t> words[eventWords];
+
+  void store(const TraceEvent &event) {
+    uint64_t copy[eventWords];
+    std::memcpy(copy, &event, sizeof(event));
+    for (size_t i = 0; i < eventWords; ++i) {
+      words[i].store(copy[i], std::memory_order_relaxed);
+    }
+  }
+
+  TraceEvent load() const {
+    uint64_t copy[eventWords];
+    for (size_t i = 0; i < eventWords; ++i) {
+      copy[i] = words[i].load(std::memory_order_relaxed);
+    }
+    TraceEvent event;
+    std::memcpy(&event, copy, sizeof(event));
+    return event;
+  }
+};
+
+struct Buffer {
+  explicit Buffer(size_t capacity) : slots(capacity), mask(capacity - 1) {}
+
+  std::vector<Slot> slots;
+  uint64_t mask;
+  std::atomic<uint64_t> head{0};
+  Clock::time_point epoch{Clock::now()};
+};
+
+// never freed, threads may still be recording into it when disabled
+std::atomic<Buffer *> theBuffer{nullptr};
+std::mutex enableMutex;
+
+std::atomic<uint32_t> nextThread{0};
+
+uint32_t currentThread() {
+  static thread_local uint32_t id = nextThread++;
+  return id;
+}
+
+void copyName(char *dst, size_t size, const std::string &name) {
+  std::strncpy(dst, name.c_str(), size - 1);
+  dst[size - 1] = '\0';
+}
+
+void writeJsonString(std::ostream &out, const char *str) {
+  out << '"';
+  for (const char *c = str; *c; ++c) {
+    switch (*c) {
+    case '"':
+      out << "\\\"";
+      break;
+    case '\\':
+      out << "\\\\";
+      break;
+    default:
+      if (static_cast<unsigned char>(*c) < 0x20) {
+        char escaped[8];
+        std::snprintf(escaped, sizeof(escaped), "\\u%04x", *c);
+        out << escaped;
+      } else {
+        out << *c;
+      }
+    }
+  }
+  out << '"';
+}
+
+} // namespace
+
+
+std::atomic<bool> Trace::isEnabled{false};
+
+void Trace::enable(size_t capacity) {
+  std::lock_guard<std::mutex> lock(enableMutex);
+
+  if (!theBuffer.load()) {
+    size_t roundedCapacity = 1;
+    while (roundedCapacity < capacity) {
+      roundedCapacity <<= 1;
+    }
+    theBuffer = new Buffer(roundedCapacity);
+  }
+
+  // publishes the buffer to recording threads, see enabled()
+  isEnabled.store(true, std::memory_order_release);
+}
+
+void Trace::disable() {
+  isEnabled = false;
+}
+
+void Trace::record(TraceEventType type,
+    const std::string &instance,
+    const std::string &task,
+    uint64_t taskId,
+    size_t queueDepth) {
+  if (!enabled()) {
+    return;
+  }
+
+  Buffer *buffer = theBuffer.load(std::memory_order_acquire);
+  if (!buffer) {
+    return;
+  }
+  const auto now = Clock::now();
+
+  const uint64_t index = buffer->head.fetch_add(1, std::memory_order_relaxed);
+  Slot &slot = buffer->slots[index & buffer->mask];
+
+  slot.sequence.store(2 * index + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+
+  TraceEvent event{};
+  event.type = type;
+  event.thread = currentThread();
+  event.queueDepth = uint32_t(queueDepth);
+  event.taskId = taskId;
+  event.timestamp = uint64_t(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(now - buffer->epoch)
+          .count());
+  copyName(event.instance, sizeof(event.instance), instance);
+  copyName(event.task, sizeof(event.task), task);
+  slot.store(event);
+
+  slot.sequence.store(2 * index + 2, std::memory_order_release);
+}
+
+std::vector<TraceEvent> Trace::events() {
+  std::vector<TraceEvent> result;
+
+  Buffer *buffer = theBuffer.load(std::memory_order_acquire);
+  if (!buffer) {
+    return result;
+  }
+
+  const uint64_t head = buffer->head.load(std::memory_order_acquire);
+  const uint64_t capacity = buffer->slots.size();
+  const uint64_t first = head > capacity ? head - capacity : 0;
+  result.reserve(head - first);
+
+  for (uint64_t index = first; index < head; ++index) {
+    const Slot &slot = buffer->slots[index & buffer->mask];
+
+    const uint64_t before = slot.sequence.load(std::memory_order_acquire);
+    if (before != 2 * index + 2) {
+      continue;
+    }
+
+    const TraceEvent event = slot.load();
+    std::atomic_thread_fence(std::memory_order_acquire);
+
+    if (slot.sequence.load(std::memory_order_relaxed) == before) {
+      result.push_back(event);
+    }
+  }
+
+  return result;
+}
+
+void Trace::writeChromeJson(std::ostream &out) {
+  const auto traceEvents = events();
+
+  out << "{\"traceEvents\":[\n";
+
+  bool first = true;
+  for (const auto &e : traceEvents) {
+    out << (first ? "" : ",\n");
+    first = false;
+
+    char ts[32];
+    std::snprintf(ts, sizeof(ts), "%.3f", e.timestamp / 1000.0);
+    const std::string common = std::string(",\"pid\":1,\"tid\":")
+        + std::to_string(e.thread) + ",\"ts\":" + ts;
+
+    switch (e.type) {
+    case TraceEventType::ENQUEUE:
+    case TraceEventType::DEQUEUE:
+      out << "{\"name\":";
+      writeJsonString(out, (std::string(e.instance) + " queue").c_str());
+      out << ",\"ph\":\"C\"" << common << ",\"args\":{\"depth\":"
+          << e.queueDepth << "}}";
+      if (e.type == TraceEventType::DEQUEUE) {
+        break;
+      }
+      out << ",\n{\"name\":";
+      writeJsonString(out, e.task);
+      out << ",\"cat\":";
+      writeJsonString(out, e.instance);
+      out << ",\"ph\":\"i\",\"s\":\"t\"" << common
+          << ",\"args\":{\"event\":\"enqueue\",\"id\":" << e.taskId << "}}";
+      break;
+    case TraceEventType::START:
+      out << "{\"name\":";
+      writeJsonString(out, e.task);
+      out << ",\"cat\":";
+      writeJsonString(out, e.instance);
+      out << ",\"ph\":\"B\"" << common << ",\"args\":{\"id\":" << e.taskId
+          << "}}";
+      break;
+    case TraceEventType::FINISH:
+    case TraceEventType::FAIL:
+      out << "{\"ph\":\"E\"" << common << ",\"args\":{\"failed\":"
+          << (e.type == TraceEventType::FAIL ? "true" : "false") << "}}";
+      break;
+    case TraceEventType::CANCEL:
+      out << "{\"name\":";
+      writeJsonString(out, e.task);
+      out << ",\"cat\":";
+      writeJsonString(out, e.instance);
+      out << ",\"ph\":\"i\",\"s\":\"t\"" << common
+          << ",\"args\":{\"event\":\"cancel\",\"id\":" << e.taskId << "}}";
+      break;
+    }
+  }
+
+  out << "\n],\"displayTimeUnit\":\"ms\"}\n";
+}
+
+bool Trace::writeChromeJson(const std::string &fileName) {
+  std::ofstream out(fileName);
+  if (!out) {
+    return false;
+  }
+
+  writeChromeJson(out);
+  return bool(out);
+}
+
+
+} // namespace scheduler
+} // namespace sg
+} // namespace ospray
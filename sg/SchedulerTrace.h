@@ -0,0 +1,80 @@
+// Copyright 2009 Intel Corporation
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "Node.h" // for OSPSG_INTERFACE
+
+namespace ospray {
+namespace sg {
+namespace scheduler {
+
+
+enum class TraceEventType : uint8_t {
+  ENQUEUE, // ready to run
+  DEQUEUE,
+  START,
+  FINISH,
+  FAIL,
+  CANCEL,
+};
+
+
+struct TraceEvent {
+  TraceEventType type;
+  // small id of the recording thread, in order of their first event
+  uint32_t thread;
+  // of the task's instance, as left by en- or dequeueing
+  uint32_t queueDepth;
+  uint64_t taskId;
+  // nanoseconds since tracing was first enabled
+  uint64_t timestamp;
+  // truncated names
+  char instance[16];
+  char task[48];
+};
+
+
+// Scheduler events in a fixed-size ring buffer, overwriting the oldest ones
+// once full. Recording doesn't lock, and costs a single atomic load while
+// tracing is disabled.
+class OSPSG_INTERFACE Trace {
+public:
+  // Starts recording. The buffer is allocated on first use with room for
+  // 'capacity' events (rounded up to a power of two) and kept from then on.
+  static void enable(size_t capacity = size_t(1) << 16);
+  static void disable();
+
+  // Acquires the buffer enable() allocated before setting the flag
+  static bool enabled() {
+    return isEnabled.load(std::memory_order_acquire);
+  }
+
+  static void record(TraceEventType type,
+      const std::string &instance,
+      const std::string &task,
+      uint64_t taskId,
+      size_t queueDepth = 0);
+
+  // Events still in the buffer, oldest first. Events overwritten while
+  // copying them are left out.
+  static std::vector<TraceEvent> events();
+
+  // Chrome trace event JSON, as loaded by chrome://tracing or Perfetto
+  static void writeChromeJson(std::ostream &out);
+  static bool writeChromeJson(const std::string &fileName);
+
+private:
+  static std::atomic<bool> isEnabled;
+};
+
+
+} // namespace scheduler
+} // namespace sg
+} // namespace ospray
@@ -0,0 +1,449 @@
+// Copyright 2009 Intel Corporation
+// SPDX-License-Identifier: Apache-2.0
+
+#include "SearchIndex.h"
+// stl
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <mutex>
+
+namespace ospray {
+namespace sg {
+
+namespace {
+
+using Trigram = uint32_t;
+using EntryId = uint32_t;
+
+// Names are prefixed with this to index the trigram at their start, which
+// prefix queries look up
+constexpr char nameStart = '\0';
+
+// Distinct trigrams of 'text'
+std::vector<Trigram> trigramsOf(const std::string &text)
+{
+  std::vector<Trigram> grams;
+  for (size_t i = 0; i + 3 <= text.size(); ++i) {
+    const auto *c = reinterpret_cast<const unsigned char *>(&text[i]);
+    grams.push_back(Trigram(c[0]) << 16 | Trigram(c[1]) << 8 | c[2]);
+  }
+  std::sort(grams.begin(), grams.end());
+  grams.erase(std::unique(grams.begin(), grams.end()), grams.end());
+  return grams;
+}
+
+struct Entry
+{
+  // expired once the node is destroyed, reset when it's erased
+  std::weak_ptr<Node> node;
+};
+
+// A link or unlink recorded by Node, in a lock-free list
+struct Change
+{
+  std::weak_ptr<Node> node;
+  bool linked;
+  Change *next;
+};
+
+// Changes recorded before the thread recording them applies them
+constexpr size_t changeBatch = 4096;
+
+} // namespace
+
+struct SearchIndex::Index
+{
+  // written with the mutex held, read by the recording threads
+  std::atomic<Node *> root{nullptr};
+
+  // guards everything below, queries and applying the changes take it
+  std::mutex mutex;
+
+  // newest first
+  std::atomic<Change *> changes{nullptr};
+  std::atomic<size_t> numChanges{0};
+
+  // entry of id i is at i - 1, dead entries stay until compacted
+  std::vector<Entry> entries;
+  // live entries as of the last compaction
+  size_t numCompacted{0};
+
+  std::unordered_map<Trigram, std::vector<EntryId>> byTrigram;
+  std::unordered_map<int, std::vector<EntryId>> byType;
+  std::unordered_map<std::string, std::vector<EntryId>> bySubType;
+};
+
+std::atomic<bool> SearchIndex::isEnabled{false};
+
+// never destroyed, nodes may be released after static destruction
+SearchIndex::Index &SearchIndex::theIndex()
+{
+  static auto *index = new Index;
+  return *index;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Index maintenance //////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+// Recording doesn't take the index mutex. A node's searchId is only written
+// with it held, but read by the recording threads.
+
+void SearchIndex::recordLink(Node &parent, Node &node)
+{
+  auto &index = theIndex();
+  // Nodes linked below a parent which isn't indexed are indexed with it,
+  // once it's linked itself
+  if (&parent != index.root
+      && !parent.properties.searchId.load(std::memory_order_acquire))
+    return;
+
+  record(index, node, true);
+}
+
+void SearchIndex::recordUnlink(Node &node)
+{
+  auto &index = theIndex();
+  if (!node.properties.searchId.load(std::memory_order_acquire))
+    return;
+
+  record(index, node, false);
+}
+
+void SearchIndex::record(Index &index, Node &node, bool linked)
+{
+  auto *change = new Change{node.shared_from_this(), linked, nullptr};
+  change->next = index.changes.load(std::memory_order_relaxed);
+  while (!index.changes.compare_exchange_weak(
+      change->next, change, std::memory_order_release))
+    ;
+
+  // Applied by the next query, or here once a batch piled up meanwhile
+  if (++index.numChanges >= changeBatch) {
+    std::unique_lock<std::mutex> lock(index.mutex, std::try_to_lock);
+    if (lock.owns_lock())
+      applyChanges(index);
+  }
+}
+
+// All helpers below expect the index mutex to be held
+
+void SearchIndex::applyChanges(Index &index)
+{
+  Change *list = index.changes.exchange(nullptr, std::memory_order_acquire);
+  index.numChanges = 0;
+
+  // oldest first
+  Change *oldest = nullptr;
+  while (list) {
+    auto *next = list->next;
+    list->next = oldest;
+    oldest = list;
+    list = next;
+  }
+
+  // The structure as it is now decides, whatever happened in between
+  while (oldest) {
+    std::unique_ptr<Change> change(oldest);
+    oldest = oldest->next;
+
+    auto node = change->node.lock();
+    if (!node || !index.root)
+      continue;
+
+    if (change->linked) {
+      if (isLinked(index, *node))
+        indexSubtree(index, *node);
+    } else {
+      eraseUnlinked(index, *node);
+    }
+  }
+
+  compact(index);
+}
+
+bool SearchIndex::isIndexed(const Index &index, const Node &node)
+{
+  return &node == index.root || node.properties.searchId.load();
+}
+
+// Whether 'node' has a parent in the index
+bool SearchIndex::isLinked(const Index &index, Node &node)
+{
+  std::lock_guard<SpinLock> lock(node.properties.structureLock);
+  for (auto *p : node.properties.parents) {
+    if (isIndexed(index, *p))
+      return true;
+  }
+  return false;
+}
+
+void SearchIndex::addPostings(Index &index, const Node &node, EntryId id)
+{
+  const auto &name = node.properties.name;
+  for (auto gram : trigramsOf(nameStart + name))
+    index.byTrigram[gram].push_back(id);
+  index.byType[int(node.type())].push_back(id);
+  index.bySubType[node.properties.subType].push_back(id);
+}
+
+// Indexes 'node' and the nodes below it which aren't yet. The subtree of an
+// indexed node is indexed as well.
+void SearchIndex::indexSubtree(Index &index, Node &node)
+{
+  std::vector<NodePtr> pending{node.shared_from_this()};
+  while (!pending.empty()) {
+    auto next = std::move(pending.back());
+    pending.pop_back();
+    if (next->properties.searchId)
+      continue;
+
+    index.entries.push_back({next});
+    const auto id = EntryId(index.entries.size());
+    // Links recorded from here on are applied, earlier ones are seen below
+    next->properties.searchId = id;
+    addPostings(index, *next, id);
+
+    std::lock_guard<SpinLock> lock(next->properties.structureLock);
+    for (auto &c : next->properties.children)
+      pending.push_back(c.second);
+  }
+}
+
+// Erases 'node' if it has no indexed parent left, and so the nodes below it
+void SearchIndex::eraseUnlinked(Index &index, Node &node)
+{
+  std::vector<NodePtr> pending{node.shared_from_this()};
+  while (!pending.empty()) {
+    auto next = std::move(pending.back());
+    pending.pop_back();
+    const auto id = next->properties.searchId.load();
+    if (!id || isLinked(index, *next))
+      continue;
+
+    index.entries[id - 1].node.reset();
+    next->properties.searchId = 0;
+
+    std::lock_guard<SpinLock> lock(next->properties.structureLock);
+    for (auto &c : next->properties.children)
+      pending.push_back(c.second);
+  }
+}
+
+// Drops the dead entries (of erased or destroyed nodes), which posting lists
+// still refer to, once the index doubled since it was last compacted
+void SearchIndex::compact(Index &index)
+{
+  if (index.entries.size() < 1024
+      || index.entries.size() < 2 * index.numCompacted)
+    return;
+
+  std::vector<NodePtr> nodes;
+  nodes.reserve(index.entries.size());
+  for (auto &e : index.entries) {
+    if (auto node = e.node.lock())
+      nodes.push_back(node);
+  }
+
+  index.entries.clear();
+  index.byTrigram.clear();
+  index.byType.clear();
+  index.bySubType.clear();
+
+  for (auto &node : nodes) {
+    index.entries.push_back({node});
+    const auto id = EntryId(index.entries.size());
+    node->properties.searchId = id;
+    addPostings(index, *node, id);
+  }
+  index.numCompacted = nodes.size();
+}
+
+void SearchIndex::clear(Index &index)
+{
+  for (auto &e : index.entries) {
+    if (auto node = e.node.lock())
+      node->properties.searchId = 0;
+  }
+  index.entries.clear();
+  index.numCompacted = 0;
+  index.byTrigram.clear();
+  index.byType.clear();
+  index.bySubType.clear();
+
+  auto *list = index.changes.exchange(nullptr);
+  index.numChanges = 0;
+  while (list) {
+    std::unique_ptr<Change> change(list);
+    list = list->next;
+  }
+}
+
+void SearchIndex::enable(Node &root)
+{
+  auto &index = theIndex();
+  std::lock_guard<std::mutex> lock(index.mutex);
+
+  if (index.root != &root) {
+    clear(index);
+    index.root = &root;
+  }
+  isEnabled = true;
+
+  // Nodes are indexed once, however many parents they have
+  std::vector<NodePtr> children;
+  {
+    std::lock_guard<SpinLock> lock(root.properties.structureLock);
+    for (auto &c : root.properties.children)
+      children.push_back(c.second);
+  }
+  for (auto &child : children)
+    indexSubtree(index, *child);
+}
+
+void SearchIndex::disable()
+{
+  auto &index = theIndex();
+  std::lock_guard<std::mutex> lock(index.mutex);
+  isEnabled = false;
+  clear(index);
+  index.root = nullptr;
+}
+
+bool SearchIndex::covers(Node &node)
+{
+  auto &index = theIndex();
+  std::lock_guard<std::mutex> lock(index.mutex);
+  applyChanges(index);
+  return enabled() && isIndexed(index, node);
+}
+
+size_t SearchIndex::size()
+{
+  auto &index = theIndex();
+  std::lock_guard<std::mutex> lock(index.mutex);
+  applyChanges(index);
+  return std::count_if(index.entries.begin(),
+      index.entries.end(),
+      [](const Entry &e) { return !e.node.expired(); });
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Queries ////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+static const std::vector<EntryId> noCandidates;
+
+// Collects the candidates matching 'matches' which a traversal of 'root'
+// would reach, ie. through a path of parents which don't match
+template <typename MATCH_T>
+SearchResults SearchIndex::collect(Index &index,
+    Node &root,
+    const std::vector<EntryId> &candidates,
+    MATCH_T &&matches)
+{
+  SearchResults results;
+
+  // the traversal doesn't go any further than a matching root
+  if (matches(root)) {
+    results.push_back(root.shared_from_this());
+    return results;
+  }
+
+  std::unordered_map<const Node *, bool> reached;
+  reached[&root] = true;
+
+  std::function<bool(Node &)> isReached = [&](Node &node) {
+    auto found = reached.find(&node);
+    if (found != reached.end())
+      return found->second;
+
+    ParentList parents;
+    {
+      std::lock_guard<SpinLock> lock(node.properties.structureLock);
+      parents = node.properties.parents;
+    }
+
+    bool result = false;
+    for (auto *p : parents) {
+      if (!matches(*p) && isReached(*p)) {
+        result = true;
+        break;
+      }
+    }
+    reached[&node] = result;
+    return result;
+  };
+
+  for (auto id : candidates) {
+    auto node = index.entries[id - 1].node.lock();
+    if (node && node.get() != &root && matches(*node) && isReached(*node))
+      results.push_back(node);
+  }
+
+  return results;
+}
+
+SearchResults SearchIndex::find(
+    Node &root, const std::string &term, NodeType type, Match match)
+{
+  auto &index = theIndex();
+  std::lock_guard<std::mutex> lock(index.mutex);
+  applyChanges(index);
+
+  const bool prefix = match == Match::PREFIX;
+  auto matches = [&](const Node &node) {
+    const auto &name = node.properties.name;
+    if (type != NodeType::GENERIC && node.type() != type)
+      return false;
+    return prefix ? name.compare(0, term.size(), term) == 0
+                  : name.find(term) != std::string::npos;
+  };
+
+  // The shortest posting list of the term's trigrams holds all matches
+  const std::vector<EntryId> *candidates = nullptr;
+  for (auto gram : trigramsOf(prefix ? nameStart + term : term)) {
+    auto found = index.byTrigram.find(gram);
+    if (found == index.byTrigram.end()) {
+      candidates = &noCandidates;
+      break;
+    }
+    if (!candidates || found->second.size() < candidates->size())
+      candidates = &found->second;
+  }
+
+  // Short terms have no trigrams, all nodes of the type are candidates then
+  std::vector<EntryId> all;
+  if (!candidates && type != NodeType::GENERIC) {
+    auto found = index.byType.find(int(type));
+    candidates = found != index.byType.end() ? &found->second : &noCandidates;
+  } else if (!candidates) {
+    all.resize(index.entries.size());
+    for (EntryId id = 1; id <= all.size(); ++id)
+      all[id - 1] = id;
+    candidates = &all;
+  }
+
+  return collect(index, root, *candidates, matches);
+}
+
+SearchResults SearchIndex::findSubType(Node &root, const std::string &subType)
+{
+  auto &index = theIndex();
+  std::lock_guard<std::mutex> lock(index.mutex);
+  applyChanges(index);
+
+  auto matches = [&](const Node &node) {
+    return node.properties.subType == subType;
+  };
+
+  auto found = index.bySubType.find(subType);
+  return collect(index,
+      root,
+      found != index.bySubType.end() ? found->second : noCandidates,
+      matches);
+}
+
+} // namespace sg
+} // namespace ospray
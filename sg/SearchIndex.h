@@ -0,0 +1,105 @@
+// Copyright 2009 Intel Corporation
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include "visitors/Search.h"
+// stl
+#include <atomic>
+
+namespace ospray {
+namespace sg {
+
+///////////////////////////////////////////////////////////////////////////////
+// Scene search index /////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+// Index of the nodes below the root it's enabled on, by the trigrams of their
+// name, by type and by subtype. It only holds weak references.
+//
+// Node::add() and remove() only record links and unlinks below indexed nodes,
+// in a lock-free log which the next query (or the thread recording a full
+// batch) applies. Subgraphs built elsewhere, eg. by importers, cost nothing
+// until they're linked into the indexed tree, which indexes them at once.
+// Nodes no longer reachable through indexed parents leave the index with
+// their subtree.
+//
+// Queries return what the Search visitor finds when traversing 'root': the
+// matching nodes below it, without descending into matches.
+class OSPSG_INTERFACE SearchIndex
+{
+ public:
+  enum class Match
+  {
+    SUBSTRING,
+    PREFIX
+  };
+
+  // Starts indexing the subtree of 'root', which has to outlive the index or
+  // disable it. An index enabled on another root is dropped first.
+  static void enable(Node &root);
+  // Stops indexing and drops the index
+  static void disable();
+
+  static bool enabled()
+  {
+    return isEnabled.load(std::memory_order_relaxed);
+  }
+
+  // Whether queries below 'node' can be answered by the index
+  static bool covers(Node &node);
+
+  // Nodes of 'type' (GENERIC for any) below 'root' whose name contains (or
+  // starts with) 'term'
+  static SearchResults find(Node &root,
+      const std::string &term,
+      NodeType type = NodeType::GENERIC,
+      Match match = Match::SUBSTRING);
+
+  // Nodes of 'subType' below 'root'
+  static SearchResults findSubType(Node &root, const std::string &subType);
+
+  // Number of indexed nodes
+  static size_t size();
+
+ private:
+  // Called by Node on structural changes
+  static void linked(Node &parent, Node &node)
+  {
+    if (enabled())
+      recordLink(parent, node);
+  }
+  static void unlinked(Node &node)
+  {
+    if (enabled())
+      recordUnlink(node);
+  }
+
+  static void recordLink(Node &parent, Node &node);
+  static void recordUnlink(Node &node);
+
+  struct Index;
+  static void record(Index &index, Node &node, bool linked);
+  static Index &theIndex();
+  static std::atomic<bool> isEnabled;
+
+  static void applyChanges(Index &index);
+  static bool isIndexed(const Index &index, const Node &node);
+  static bool isLinked(const Index &index, Node &node);
+  static void indexSubtree(Index &index, Node &node);
+  static void eraseUnlinked(Index &index, Node &node);
+  static void addPostings(Index &index, const Node &node, uint32_t id);
+  static void compact(Index &index);
+  static void clear(Index &index);
+
+  template <typename MATCH_T>
+  static SearchResults collect(Index &index,
+      Node &root,
+      const std::vector<uint32_t> &candidates,
+      MATCH_T &&matches);
+
+  friend struct Node;
+};
+
+} // namespace sg
+} // namespace ospray
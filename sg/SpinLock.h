@@ -0,0 +1,48 @@
+// Copyright 2009 Intel Corporation
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+// stl
+#include <atomic>
+#include <thread>
+
+namespace ospray {
+namespace sg {
+
+// Single byte lock for short critical sections on per-node state, where a
+// std::mutex per node would cost more memory than the data it guards.
+// Satisfies Lockable, so it works with std::lock_guard and std::lock.
+class SpinLock
+{
+ public:
+  SpinLock() = default;
+
+  SpinLock(const SpinLock &) = delete;
+  SpinLock &operator=(const SpinLock &) = delete;
+
+  void lock()
+  {
+    while (locked.exchange(true, std::memory_order_acquire)) {
+      while (locked.load(std::memory_order_relaxed))
+        std::this_thread::yield();
+    }
+  }
+
+  bool try_lock()
+  {
+    return !locked.load(std::memory_order_relaxed)
+        && !locked.exchange(true, std::memory_order_acquire);
+  }
+
+  void unlock()
+  {
+    locked.store(false, std::memory_order_release);
+  }
+
+ private:
+  std::atomic<bool> locked{false};
+};
+
+} // namespace sg
+} // namespace ospray
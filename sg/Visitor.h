@@ -39,6 +39,23 @@ namespace ospray {
 
   inline void Visitor::postChildren(Node &, TraversalContext &) {}
 
+  // Parallel traversal ///////////////////////////////////////////////////////
+
+  // Tag for the constructor Node::traverseParallel() uses to create a
+  // task-local visitor from the one in progress:
+  //
+  //   VISITOR_T(const VISITOR_T &parent, ParallelSplit);
+  //
+  // The task-local visitor starts with empty results, which are merged back
+  // in traversal order after the subtrees are done through
+  //
+  //   void VISITOR_T::reduce(VISITOR_T &taskLocal);
+  //
+  // Only read-only visitors may be used with traverseParallel().
+  struct ParallelSplit
+  {
+  };
+
   // Visitor type traits //////////////////////////////////////////////////////
 
   // NOTE(jda) - This checks at compile time if T implements the method
@@ -20,6 +20,15 @@ Camera::Camera(const std::string &type)
   createChild("imageStart", "vec2f", vec2f(0.f));
   createChild("imageEnd", "vec2f", vec2f(1.f));
 
+  // Part of the image region above which is rendered, set by the frame's
+  // region of interest
+  createChild("roiStart", "vec2f", vec2f(0.f));
+  createChild("roiEnd", "vec2f", vec2f(1.f));
+  child("roiStart").setSGOnly();
+  child("roiStart").setSGNoUI();
+  child("roiEnd").setSGOnly();
+  child("roiEnd").setSGNoUI();
+
   createChild("lookAt", "vec3f", vec3f(1.f));
   child("lookAt").setSGOnly();
 
@@ -78,6 +87,17 @@ void Camera::preCommit()
 
   // call baseClass preCommit to finish node
   OSPNode::preCommit();
+
+  // Narrow the image region to the region of interest
+  auto roiStart = child("roiStart").valueAs<vec2f>();
+  auto roiEnd = child("roiEnd").valueAs<vec2f>();
+  if (roiStart != vec2f(0.f) || roiEnd != vec2f(1.f)) {
+    auto imageStart = child("imageStart").valueAs<vec2f>();
+    auto imageEnd = child("imageEnd").valueAs<vec2f>();
+    auto extent = imageEnd - imageStart;
+    handle().setParam("imageStart", imageStart + roiStart * extent);
+    handle().setParam("imageEnd", imageStart + roiEnd * extent);
+  }
 }
 
 } // namespace sg
@@ -0,0 +1,156 @@
+// Copyright 2009 Intel Corporation
+// SPDX-License-Identifier: Apache-2.0
+
+#include "PickBuffer.h"
+// rkcommon
+#include "rkcommon/tasking/parallel_for.h"
+// stl
+#include <algorithm>
+
+namespace ospray {
+namespace sg {
+
+// OSPRay's id of a pixel without a hit
+static constexpr uint32_t missId = uint32_t(-1);
+
+void PickBuffer::update(FrameBuffer &fb, const box2f &region)
+{
+  if (!fb.hasInstanceIDChannel() || !fb.hasObjectIDChannel()) {
+    clear();
+    return;
+  }
+
+  // The framebuffer is never smaller than a pixel
+  auto fbSize = fb.child("size").valueAs<vec2i>();
+  fbSize = vec2i(std::max(fbSize.x, 1), std::max(fbSize.y, 1));
+
+  const bool fullFrame =
+      region.lower == vec2f(0.f) && region.upper == vec2f(1.f);
+  if (fullFrame) {
+    size = fbSize;
+  } else if (!valid()) {
+    // Nothing to place the region in
+    return;
+  }
+
+  // Pixel of the full image at the region's lower left corner
+  const vec2i offset = fullFrame
+      ? vec2i(0)
+      : vec2i(region.lower * vec2f(size) + vec2f(0.5f));
+  const int x0 = std::max(0, -offset.x);
+  const int x1 = std::min(fbSize.x, size.x - offset.x);
+  const int y0 = std::max(0, -offset.y);
+  const int y1 = std::min(fbSize.y, size.y - offset.y);
+
+  auto copyChannel = [&](OSPFrameBufferChannel channel,
+                         std::vector<uint32_t> &ids) {
+    const auto *mapped = static_cast<const uint32_t *>(fb.map(channel));
+    if (fullFrame) {
+      ids.assign(mapped, mapped + size_t(size.x) * size.y);
+    } else {
+      for (int y = y0; y < y1; ++y) {
+        const auto *row = mapped + size_t(y) * fbSize.x;
+        std::copy(row + x0,
+            row + x1,
+            ids.begin() + size_t(y + offset.y) * size.x + offset.x + x0);
+      }
+    }
+    fb.unmap(mapped);
+  };
+  copyChannel(OSP_FB_ID_INSTANCE, instanceIds);
+  copyChannel(OSP_FB_ID_OBJECT, objectIds);
+}
+
+void PickBuffer::clear()
+{
+  size = vec2i(0);
+  instanceIds.clear();
+  objectIds.clear();
+}
+
+bool PickBuffer::valid() const
+{
+  return !instanceIds.empty();
+}
+
+vec2i PickBuffer::pixelOf(const vec2f &pos) const
+{
+  return vec2i(clamp(int(pos.x * size.x), 0, size.x - 1),
+      clamp(int(pos.y * size.y), 0, size.y - 1));
+}
+
+bool PickBuffer::pick(const vec2f &pos, Hit &hit)
+{
+  if (!valid())
+    return false;
+
+  const auto pixel = pixelOf(pos);
+  const size_t i = size_t(pixel.y) * size.x + pixel.x;
+  hit = {instanceIds[i], objectIds[i]};
+  return hit.instanceId != missId;
+}
+
+std::vector<std::vector<PickBuffer::Hit>> PickBuffer::pick(
+    const std::vector<box2f> &regions)
+{
+  std::vector<std::vector<Hit>> hits(regions.size());
+  if (!valid())
+    return hits;
+
+  // One task per row of every region
+  struct Row
+  {
+    size_t region;
+    int y;
+    int x0, x1; // [x0, x1)
+  };
+  std::vector<Row> rows;
+  for (size_t r = 0; r < regions.size(); ++r) {
+    // a region dragged up or left has its corners swapped
+    const auto &region = regions[r];
+    const auto lower = pixelOf(min(region.lower, region.upper));
+    const auto upper = pixelOf(max(region.lower, region.upper));
+    for (int y = lower.y; y <= upper.y; ++y)
+      rows.push_back({r, y, lower.x, upper.x + 1});
+  }
+
+  // Hits as sortable keys, instance id in the upper half
+  auto keyOf = [](uint32_t instanceId, uint32_t objectId) {
+    return uint64_t(instanceId) << 32 | objectId;
+  };
+  auto distinct = [](std::vector<uint64_t> &keys) {
+    std::sort(keys.begin(), keys.end());
+    keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+  };
+
+  std::vector<std::vector<uint64_t>> rowKeys(rows.size());
+  tasking::parallel_for(rows.size(), [&](size_t t) {
+    const auto &row = rows[t];
+    auto &keys = rowKeys[t];
+    const size_t begin = size_t(row.y) * size.x;
+    for (size_t i = begin + row.x0; i < begin + row.x1; ++i) {
+      const auto key = keyOf(instanceIds[i], objectIds[i]);
+      // runs of pixels are mostly on the same object
+      if (instanceIds[i] != missId && (keys.empty() || keys.back() != key))
+        keys.push_back(key);
+    }
+    distinct(keys);
+  });
+
+  std::vector<std::vector<uint64_t>> regionKeys(regions.size());
+  for (size_t t = 0; t < rows.size(); ++t) {
+    auto &keys = regionKeys[rows[t].region];
+    keys.insert(keys.end(), rowKeys[t].begin(), rowKeys[t].end());
+  }
+
+  for (size_t r = 0; r < regions.size(); ++r) {
+    distinct(regionKeys[r]);
+    for (auto key : regionKeys[r])
+      hits[r].push_back({uint32_t(key >> 32), uint32_t(key)});
+  }
+
+  return hits;
+}
+
+} // namespace sg
+} // namespace ospray
@@ -0,0 +1,56 @@
+// Copyright 2009 Intel Corporation
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include "FrameBuffer.h"
+
+namespace ospray {
+namespace sg {
+
+// Picking from the ID buffers of the last finished frame. Queries read a
+// copy of the instance and object ID channels instead of casting a ray
+// through the device, which has to wait for the frame in flight. The copy
+// has to follow every finished frame, queries aren't answered once it
+// doesn't.
+class OSPSG_INTERFACE PickBuffer
+{
+ public:
+  struct Hit
+  {
+    // RenderScene writes the sgInstId and sgGeomId of the hit, which
+    // World::instanceNodes and World::geometryNodes map to their nodes
+    uint32_t instanceId;
+    uint32_t objectId;
+  };
+
+  // Copies the ID channels of 'fb', to be called for every finished frame.
+  // A frame of only the 'region' of the image (normalized, as below)
+  // updates that part of the last full frame's copy.
+  void update(FrameBuffer &fb,
+      const box2f &region = box2f(vec2f(0.f), vec2f(1.f)));
+
+  // Drops the copy, eg. when the last frame was canceled
+  void clear();
+
+  // Whether queries have a copy of the last finished frame to answer from
+  bool valid() const;
+
+  // Hit at 'pos', in normalized coordinates with the origin at the lower
+  // left (as ospPick), false on a miss
+  bool pick(const vec2f &pos, Hit &hit);
+
+  // Distinct hits in each of 'regions' (normalized coordinates, as above),
+  // all regions are scanned in one parallel pass
+  std::vector<std::vector<Hit>> pick(const std::vector<box2f> &regions);
+
+ private:
+  vec2i pixelOf(const vec2f &pos) const;
+
+  vec2i size{0};
+  std::vector<uint32_t> instanceIds;
+  std::vector<uint32_t> objectIds;
+};
+
+} // namespace sg
+} // namespace ospray
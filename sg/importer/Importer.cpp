@@ -156,9 +156,9 @@ OSPSG_INTERFACE void importScene(
 
       // Parse entire generator json for children.  Only add valid values
       auto children = createNodeFromJSON(jG)->children();
-      std::function<void(Node &, const FlatMap<std::string, NodePtr> &)>
+      std::function<void(Node &, const ChildMap &)>
           setJsonValues = [&setJsonValues](Node &node,
-                          const FlatMap<std::string, NodePtr> &children) {
+                          const ChildMap &children) {
             for (auto &child : children) {
               auto &cn = child.second;
               if (cn->value().valid()) {
@@ -173,7 +173,10 @@ OSPSG_INTERFACE void importScene(
             }
           };
 
-      setJsonValues(*gen, children);
+      {
+        ModificationTransaction transaction;
+        setJsonValues(*gen, children);
+      }
 
       // Commit any parameter changes
       gen->commit();
@@ -202,37 +205,41 @@ OSPSG_INTERFACE void importScene(
   if (j.contains("materialRegistry")) {
     sg::NodePtr materials = createNodeFromJSON(j["materialRegistry"]);
 
-    for (auto &mat : materials->children()) {
-      // skip non-material nodes (e.g. renderer type)
-      if (mat.second->type() != NodeType::MATERIAL)
-        continue;
-
-      // XXX temporary workaround.  Just set params on existing materials.
-      // Prevents loss of texture data.  Will be fixed when textures can reload.
-
-      // Modify existing material or create new material
-      // (account for change of material type)
-      if (context->baseMaterialRegistry->hasChild(mat.first)
-          && context->baseMaterialRegistry->child(mat.first).subType()
-              == mat.second->subType()) {
-        auto &bMat = context->baseMaterialRegistry->child(mat.first);
-
-        for (auto &param : mat.second->children()) {
-          auto &p = *param.second;
-
-          // This is a generated node value and can't be imported
-          if (param.first == "handles")
-            continue;
-
-          // Modify existing param or create new params
-          if (bMat.hasChild(param.first))
-            bMat[param.first] = p.value();
-          else
-            bMat.createChild(
-                param.first, p.subType(), p.description(), p.value());
-        }
-      } else
-        context->baseMaterialRegistry->add(mat.second);
+    {
+      // batch parent notification of all material parameter updates
+      ModificationTransaction transaction;
+      for (auto &mat : materials->children()) {
+        // skip non-material nodes (e.g. renderer type)
+        if (mat.second->type() != NodeType::MATERIAL)
+          continue;
+
+        // XXX temporary workaround.  Just set params on existing materials.
+        // Prevents loss of texture data.  Will be fixed when textures can reload.
+
+        // Modify existing material or create new material
+        // (account for change of material type)
+        if (context->baseMaterialRegistry->hasChild(mat.first)
+            && context->baseMaterialRegistry->child(mat.first).subType()
+                == mat.second->subType()) {
+          auto &bMat = context->baseMaterialRegistry->child(mat.first);
+
+          for (auto &param : mat.second->children()) {
+            auto &p = *param.second;
+
+            // This is a generated node value and can't be imported
+            if (param.first == "handles")
+              continue;
+
+            // Modify existing param or create new params
+            if (bMat.hasChild(param.first))
+              bMat[param.first] = p.value();
+            else
+              bMat.createChild(
+                  param.first, p.subType(), p.description(), p.value());
+          }
+        } else
+          context->baseMaterialRegistry->add(mat.second);
+      }
     }
     // refreshScene imports all filesToImport and updates materials
     context->refreshScene(true);
@@ -124,6 +124,11 @@ struct OSPSG_INTERFACE Importer : public Node
     scheduler = _scheduler;
   }
 
+  // Cancels the tasks of the import which haven't run yet
+  inline void setCancellationToken(CancellationTokenPtr _token) {
+    cancellationToken = _token;
+  }
+
   float pointSize{0.0f};
   bool importCameras{false};
 
@@ -141,6 +146,7 @@ struct OSPSG_INTERFACE Importer : public Node
   int argc{0};
   char ** argv{nullptr};
   SchedulerPtr scheduler{nullptr};
+  CancellationTokenPtr cancellationToken{nullptr};
 };
 
 // global assets catalogue
@@ -29,7 +29,10 @@ void RawImporter::importScene()
   // Keep this object alive for the duration of any lambdas
   auto self = shared_from_this();
 
-  auto loadDataCallback = [&, self](SchedulerPtr scheduler) {
+  // Filled in by loading, which the scheduler runs before adding to the scene
+  auto rootNode = std::make_shared<NodePtr>();
+
+  auto loadDataCallback = [&, self, rootNode](SchedulerPtr) {
     // Create a root Transform/Instance off the Importer, then place the volume
     // under this.
     auto rootName = fileName.name() + "_rootXfm";
@@ -38,7 +41,7 @@ void RawImporter::importScene()
     auto last = fileName.base().find_last_of(".");
     auto volumeTypeExt = fileName.base().substr(last, fileName.base().length());
 
-    auto rootNode = createNode(rootName, "transform");
+    *rootNode = createNode(rootName, "transform");
     NodePtr volume;
 
     bool isSpherical = volumeTypeExt == ".spherical";
@@ -49,30 +52,10 @@ void RawImporter::importScene()
       volume = createNode(nodeName, "structuredRegular");
     }
 
-    for (auto &c : volumeParams->children()) {
-      // Need to make a copy of the volume parameter here. If multiple threads
-      // are using the same VolumeParams children objects, then because of the
-      // book keeping involved with a node remembering its parents, multiple
-      // threads could modify the parents vector within a Node object.
-      //
-      // Example: Threads "foo" and "bar" are running at the same time.
-      // First, Foo adds a VolumeParams child to its own Volume object. Foo
-      // recognizes that it will need to resize the Node::properties::parents
-      // vector. Foo allocates a new parents vector. Next, Bar follows the
-      // same process and allocates a new parents vector. Foo deallocates the
-      // old pointer and so does Bar, leading to a double-free.
-      //
-      // The actual reason this happens is because although the
-      // Importer::volumeParams object is newly created each time
-      // Importer::getImporter() is called, the children of each of the
-      // separate Importer::volumeParams objects are all references to the
-      // exact same Node object.
-
-      // Preferably this code would be something like:
-      //   volume->add(createNodeLike(c.second))
-      auto &p = c.second;
-      volume->createChild(p->name(), p->subType(), p->description(), p->value());
-    }
+    // Each volume gets its own copy of the volume parameters, the
+    // VolumeParams children are shared between importers
+    for (auto &c : volumeParams->children())
+      volume->add(c.second->clone(), c.first);
 
     if (isSpherical) {
       auto sphericalVolume =
@@ -88,26 +71,28 @@ void RawImporter::importScene()
     tf->child("value") = valueRange;
     volume->add(tf);
 
-    rootNode->add(volume);
-
-    auto addToSceneCallback = [&, self, rootNode](SchedulerPtr scheduler) {
-      // Finally, add node hierarchy to importer parent
-      add(rootNode);
-    }; // addToSceneCallback
-
-    if (scheduler) {
-      auto name = "add raw volume from "s + fileName.str() + " to scene"s;
-      scheduler->ospray()->push(name, addToSceneCallback);
-    } else {
-      addToSceneCallback(nullptr);
-    }
+    (*rootNode)->add(volume);
   }; // loadDataCallback
 
+  auto addToSceneCallback = [&, self, rootNode](SchedulerPtr) {
+    // Finally, add node hierarchy to importer parent
+    add(*rootNode);
+  }; // addToSceneCallback
+
   if (scheduler) {
+    TaskOptions options;
+    options.token = cancellationToken;
+
     auto name = "load raw volume from "s + fileName.str();
-    scheduler->background()->push(name, loadDataCallback);
+    auto loadTask =
+        scheduler->background()->push(name, loadDataCallback, options);
+
+    options.dependencies = {loadTask};
+    name = "add raw volume from "s + fileName.str() + " to scene"s;
+    scheduler->ospray()->push(name, addToSceneCallback, options);
   } else {
     loadDataCallback(nullptr);
+    addToSceneCallback(nullptr);
   }
 }
 
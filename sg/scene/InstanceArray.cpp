@@ -0,0 +1,220 @@
+// Copyright 2009 Intel Corporation
+// SPDX-License-Identifier: Apache-2.0
+
+#include "InstanceArray.h"
+
+namespace ospray {
+namespace sg {
+
+bool InstanceArray::find(Key &key, size_t stamp, Slot &slot)
+{
+  for (;; key.occurrence++) {
+    auto found = slotOfKey.find(key);
+    if (found == slotOfKey.end())
+      return false;
+
+    if (states[found->second].stamp != stamp) {
+      slot = found->second;
+      states[slot].stamp = stamp;
+      return true;
+    }
+  }
+}
+
+InstanceArray::Slot InstanceArray::insert(
+    const Key &key, cpp::Group group, size_t stamp)
+{
+  cpp::Instance inst(group);
+
+  Slot slot;
+  if (!freeSlots.empty()) {
+    slot = freeSlots.back();
+    freeSlots.pop_back();
+    instances[slot] = inst;
+  } else {
+    slot = Slot(instances.size());
+    instances.push_back(inst);
+    states.emplace_back();
+  }
+
+  auto &state = states[slot];
+  state = SlotState();
+  state.key = key;
+  state.group = group;
+  state.version = nextVersion++;
+  state.stamp = stamp;
+  state.used = true;
+
+  slotOfKey[key] = slot;
+  membershipChanged = true;
+  return slot;
+}
+
+bool InstanceArray::available(const Ref &ref, size_t stamp) const
+{
+  return ref.slot < states.size() && states[ref.slot].version == ref.version
+      && states[ref.slot].stamp != stamp;
+}
+
+bool InstanceArray::touch(const Ref &ref, size_t stamp)
+{
+  if (ref.slot >= states.size() || states[ref.slot].version != ref.version)
+    return false;
+
+  states[ref.slot].stamp = stamp;
+  return true;
+}
+
+void InstanceArray::releaseUnused(size_t stamp)
+{
+  for (Slot slot = 0; slot < states.size(); ++slot) {
+    if (states[slot].used && states[slot].stamp != stamp)
+      release(slot);
+  }
+}
+
+void InstanceArray::setId(Slot slot, uint32_t id)
+{
+  auto &state = states[slot];
+  if (state.id == id)
+    return;
+
+  instances[slot].setParam("id", id);
+  state.id = id;
+  state.committed = false;
+}
+
+void InstanceArray::setTransform(Slot slot, const affine3f &xfm)
+{
+  auto &state = states[slot];
+  if (state.committed && !state.motionBlur && state.xfm == xfm)
+    return;
+
+  auto &inst = instances[slot];
+  if (state.motionBlur)
+    inst.removeParam("motion.transform");
+  inst.setParam("transform", xfm);
+  inst.commit();
+
+  state.xfm = xfm;
+  state.motionBlur = false;
+  state.committed = true;
+}
+
+void InstanceArray::setTransform(
+    Slot slot, const affine3f &xfm, const affine3f &endXfm)
+{
+  auto &state = states[slot];
+  if (state.committed && state.motionBlur && state.xfm == xfm
+      && state.endXfm == endXfm)
+    return;
+
+  std::vector<affine3f> motionXfms;
+  motionXfms.push_back(xfm);
+  motionXfms.push_back(endXfm);
+
+  auto &inst = instances[slot];
+  if (!state.motionBlur)
+    inst.removeParam("transform");
+  inst.setParam("motion.transform", cpp::CopiedData(motionXfms));
+  inst.commit();
+
+  state.xfm = xfm;
+  state.endXfm = endXfm;
+  state.motionBlur = true;
+  state.committed = true;
+}
+
+cpp::Instance &InstanceArray::instance(Slot slot)
+{
+  return instances[slot];
+}
+
+cpp::Group &InstanceArray::group(Slot slot)
+{
+  return states[slot].group;
+}
+
+InstanceArray::Ref InstanceArray::ref(Slot slot) const
+{
+  return {slot, states[slot].version};
+}
+
+bool InstanceArray::placeInWorld(cpp::World &world)
+{
+  if (!membershipChanged)
+    return false;
+  membershipChanged = false;
+
+  if (size() == 0) {
+    // nothing to keep the slots for
+    instances.clear();
+    states.clear();
+    freeSlots.clear();
+    world.removeParam("instance");
+    return true;
+  }
+
+  // Placeholders would keep the world at its largest size
+  if (freeSlots.size() * 2 > instances.size())
+    compact();
+
+  // OSPRay holds references to the instances of a data array, the slots
+  // can't be shared with it as they're modified in place
+  world.setParam("instance", cpp::CopiedData(instances));
+  return true;
+}
+
+size_t InstanceArray::size() const
+{
+  return slotOfKey.size();
+}
+
+size_t InstanceArray::numSlots() const
+{
+  return instances.size();
+}
+
+void InstanceArray::release(Slot slot)
+{
+  if (!placeholder.handle()) {
+    cpp::Group empty;
+    empty.commit();
+    placeholder = cpp::Instance(empty);
+    placeholder.commit();
+  }
+
+  auto &state = states[slot];
+  slotOfKey.erase(state.key);
+  state = SlotState();
+
+  instances[slot] = placeholder;
+  freeSlots.push_back(slot);
+  membershipChanged = true;
+}
+
+void InstanceArray::compact()
+{
+  // Live slots keep their order, a moved slot gets a new version so that
+  // refs to either of its indices fail and their users look it up again
+  Slot next = 0;
+  for (Slot slot = 0; slot < states.size(); ++slot) {
+    if (!states[slot].used)
+      continue;
+
+    if (slot != next) {
+      instances[next] = std::move(instances[slot]);
+      states[next] = std::move(states[slot]);
+      states[next].version = nextVersion++;
+      slotOfKey[states[next].key] = next;
+    }
+    next++;
+  }
+
+  instances.erase(instances.begin() + next, instances.end());
+  states.erase(states.begin() + next, states.end());
+  freeSlots.clear();
+}
+
+} // namespace sg
+} // namespace ospray
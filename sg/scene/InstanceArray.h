@@ -0,0 +1,132 @@
+// Copyright 2009 Intel Corporation
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include "sg/Node.h"
+
+namespace ospray {
+namespace sg {
+
+// The instances of a world, in slots which keep their index for as long as
+// the instance exists. An instance is identified by the node creating it, the
+// object it instantiates and the path the node was reached along, as a node
+// shared by several parents creates an instance for each; when a traversal
+// finds it again it's updated in place instead of being created anew. The
+// world's instance list is only set again when instances are added or
+// removed. Released slots are reused, and once most of them are free the
+// live instances are moved down, which invalidates their refs.
+class OSPSG_INTERFACE InstanceArray
+{
+ public:
+  using Slot = uint32_t;
+
+  struct Key
+  {
+    const Node *node;
+    const void *object;
+    // the transforms above the node, as hashed by RenderScene
+    uint64_t path{0};
+    // tells apart visits along the same path, eg. through several parents
+    // which aren't transforms
+    uint32_t occurrence{0};
+
+    bool operator==(const Key &o) const
+    {
+      return node == o.node && object == o.object && path == o.path
+          && occurrence == o.occurrence;
+    }
+  };
+
+  // A slot as it was acquired, invalid once the instance is released
+  struct Ref
+  {
+    Slot slot;
+    uint32_t version;
+  };
+
+  // Looks up the slot of the instance with 'key' and marks it as used in
+  // traversal 'stamp'. A slot already used in this traversal belongs to
+  // another visit of the same node, the occurrence of 'key' is advanced past
+  // those, so that a new instance is inserted with it if none is left.
+  bool find(Key &key, size_t stamp, Slot &slot);
+
+  // Adds a new instance of 'group' with 'key', in a free slot if any, used in
+  // traversal 'stamp'
+  Slot insert(const Key &key, cpp::Group group, size_t stamp);
+
+  // Whether an acquired slot is still live and not used in traversal 'stamp'
+  // yet
+  bool available(const Ref &ref, size_t stamp) const;
+
+  // Marks an acquired slot as still used in traversal 'stamp', returns false
+  // if it was released meanwhile
+  bool touch(const Ref &ref, size_t stamp);
+
+  // Releases all instances not used in traversal 'stamp'
+  void releaseUnused(size_t stamp);
+
+  // Sets the id a slot's instance writes to the instance ID buffer, it's
+  // committed with the next transform
+  void setId(Slot slot, uint32_t id);
+
+  // Sets the transform of a slot's instance, committing it only if it changed
+  void setTransform(Slot slot, const affine3f &xfm);
+  void setTransform(Slot slot, const affine3f &xfm, const affine3f &endXfm);
+
+  cpp::Instance &instance(Slot slot);
+  cpp::Group &group(Slot slot);
+  Ref ref(Slot slot) const;
+
+  // Sets the instances on 'world' if any were added or removed since the
+  // last call, compacting the slots first if most are free
+  bool placeInWorld(cpp::World &world);
+
+  // Number of live instances
+  size_t size() const;
+
+  // Number of slots, live or free
+  size_t numSlots() const;
+
+ private:
+  struct KeyHash
+  {
+    size_t operator()(const Key &key) const
+    {
+      return std::hash<const void *>()(key.node)
+          ^ (std::hash<const void *>()(key.object) << 1)
+          ^ (std::hash<uint64_t>()(key.path) << 2) ^ key.occurrence;
+    }
+  };
+
+  struct SlotState
+  {
+    Key key{nullptr, nullptr, 0, 0};
+    cpp::Group group{nullptr};
+    uint32_t version{0};
+    size_t stamp{0};
+    bool used{false};
+    // instance transform as last committed
+    bool committed{false};
+    bool motionBlur{false};
+    affine3f xfm{one};
+    affine3f endXfm{one};
+    // not set yet, like a miss in the ID buffer
+    uint32_t id{uint32_t(-1)};
+  };
+
+  void release(Slot slot);
+  void compact();
+
+  std::vector<cpp::Instance> instances;
+  std::vector<SlotState> states;
+  std::vector<Slot> freeSlots;
+  std::unordered_map<Key, Slot, KeyHash> slotOfKey;
+  // fills released slots until they're reused
+  cpp::Instance placeholder{nullptr};
+  uint32_t nextVersion{1};
+  bool membershipChanged{true};
+};
+
+} // namespace sg
+} // namespace ospray
@@ -40,6 +40,74 @@ NodeType Transform::type() const
   return NodeType::TRANSFORM;
 }
 
+static bool modifiedSince(const Node &node, const TimeStamp &time)
+{
+  // an added or changed endKey modifies the children
+  return node.lastModified() > time || node.childrenLastModified() > time;
+}
+
+void Transform::updateLocalXfm()
+{
+  if (!translation || lastModified() > localXfmUpdated) {
+    translation = &child("translation");
+    rotation = &child("rotation");
+    scale = &child("scale");
+  } else if (!modifiedSince(*translation, localXfmUpdated)
+      && !modifiedSince(*rotation, localXfmUpdated)
+      && !modifiedSince(*scale, localXfmUpdated)) {
+    return;
+  }
+
+  affine3f xfm = affine3f::rotate(rotation->valueAs<quaternionf>());
+  affine3f endXfm = xfm;
+  bool diverged = false;
+  if (rotation->hasChild("endKey")) {
+    diverged = true;
+    endXfm =
+        affine3f::rotate(rotation->child("endKey").valueAs<quaternionf>());
+  }
+
+  const affine3f sxfm = affine3f::scale(scale->valueAs<vec3f>());
+  xfm *= sxfm;
+  if (scale->hasChild("endKey")) {
+    diverged = true;
+    endXfm *= affine3f::scale(scale->child("endKey").valueAs<vec3f>());
+  } else
+    endXfm *= sxfm;
+
+  xfm.p = translation->valueAs<vec3f>();
+  if (translation->hasChild("endKey")) {
+    diverged = true;
+    endXfm.p = translation->child("endKey").valueAs<vec3f>();
+  } else
+    endXfm.p = xfm.p;
+
+  const auto &value = valueAs<affine3f>();
+  localXfm = xfm * value;
+  localEndXfm = endXfm * value;
+  localMotionBlur = diverged;
+
+  localXfmUpdated.renew();
+}
+
+bool Transform::computeBounds(box3f &bounds)
+{
+  bounds = box3f(empty);
+  if (hasChild("visible") && !child("visible").valueAs<bool>())
+    return true;
+
+  box3f childBounds;
+  const bool complete = Node::computeBounds(childBounds);
+  if (childBounds.empty())
+    return complete;
+
+  updateLocalXfm();
+  bounds = xfmBounds(localXfm, childBounds);
+  if (localMotionBlur)
+    bounds.extend(xfmBounds(localEndXfm, childBounds));
+  return complete;
+}
+
 OSP_REGISTER_SG_NODE_NAME(Transform, transform);
 
 } // namespace sg
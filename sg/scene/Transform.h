@@ -15,11 +15,29 @@ struct OSPSG_INTERFACE Transform : public Node_T<affine3f>
 
   NodeType type() const override;
 
+  // Rebuilds localXfm and localEndXfm from the value and the translation,
+  // rotation and scale children, only if any of them changed since the
+  // last update
+  void updateLocalXfm();
+
   affine3f localXfm{one};
   affine3f localEndXfm{one};
   affine3f accumulatedXfm{one};
   affine3f accumulatedEndXfm{one};
+  bool localMotionBlur{false}; // localEndXfm is different
   bool motionBlur{false}; // accumulatedEndXfm is different
+
+ protected:
+  // The children's bounds in the parent's space, empty if hidden
+  bool computeBounds(box3f &bounds) override;
+
+ private:
+  // Resolved children, looked up again when the structure of this node
+  // changes (which modifies it)
+  Node *translation{nullptr};
+  Node *rotation{nullptr};
+  Node *scale{nullptr};
+  TimeStamp localXfmUpdated;
 };
 
 } // namespace sg
@@ -24,9 +24,6 @@ World::World()
   child("dynamicScene").setSGNoUI();
   child("compactMode").setSGNoUI();
   child("robustMode").setSGNoUI();
-
-  instSGIdMap = std::make_shared<OSPInstanceSGIdMap>();
-  geomSGIdMap = std::make_shared<OSPGeomModelSGIdMap>();
 }
 
 void World::preCommit()
@@ -38,7 +35,37 @@ void World::preCommit()
 
 void World::postCommit()
 {
-  traverse<RenderScene>();
+  if (!renderScene)
+    renderScene = std::make_shared<RenderScene>();
+  traverse(*renderScene);
+}
+
+void World::render()
+{
+  commit();
+  // A world which didn't need a commit has never been traversed
+  if (!renderScene)
+    postCommit();
+}
+
+// SGIdTable //
+
+void SGIdTable::set(uint32_t id, Node &node)
+{
+  if (id >= entries.size())
+    entries.resize(std::max(size_t(id) + 1, entries.size() * 2));
+
+  auto &entry = entries[id];
+  if (entry.raw == &node && !entry.node.expired())
+    return;
+
+  entry.node = node.shared_from_this();
+  entry.raw = &node;
+}
+
+NodePtr SGIdTable::get(uint32_t id) const
+{
+  return id < entries.size() ? entries[id].node.lock() : nullptr;
 }
 
 OSP_REGISTER_SG_NODE_NAME(World, world);
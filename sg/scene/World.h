@@ -4,10 +4,34 @@
 #pragma once
 
 #include "sg/Node.h"
+#include "InstanceArray.h"
 
 namespace ospray {
 namespace sg {
 
+struct RenderScene;
+
+// Nodes by the sgInstId or sgGeomId given to them by RenderScene, which are
+// small, dense integers. Ids are written to the ID buffers, picking looks
+// them up here.
+class OSPSG_INTERFACE SGIdTable
+{
+ public:
+  void set(uint32_t id, Node &node);
+  // The node of 'id', null if there is none or it was destroyed
+  NodePtr get(uint32_t id) const;
+
+ private:
+  struct Entry
+  {
+    std::weak_ptr<Node> node;
+    // only compared, to set an unchanged entry without touching the node
+    const Node *raw{nullptr};
+  };
+
+  std::vector<Entry> entries;
+};
+
 struct OSPSG_INTERFACE World : public OSPNode<cpp::World, NodeType::WORLD>
 {
   World();
@@ -16,8 +40,20 @@ struct OSPSG_INTERFACE World : public OSPNode<cpp::World, NodeType::WORLD>
   virtual void preCommit() override;
   virtual void postCommit() override;
 
-  std::shared_ptr<OSPInstanceSGIdMap> instSGIdMap;
-  std::shared_ptr<OSPGeomModelSGIdMap> geomSGIdMap;
+  // Commits, the instances are brought up to date by postCommit()
+  void render() override;
+
+  // root transforms of sg instances and transforms with a geomId, by the
+  // id they write to the instance and object ID buffers
+  SGIdTable instanceNodes;
+  SGIdTable geometryNodes;
+
+  // instances placed in the world, maintained by RenderScene
+  InstanceArray instances;
+
+ private:
+  // kept across commits to only rebuild the instances of modified subtrees
+  std::shared_ptr<RenderScene> renderScene;
 };
 
 } // namespace sg
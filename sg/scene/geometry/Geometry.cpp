@@ -2,6 +2,9 @@
 // SPDX-License-Identifier: Apache-2.0
 
 #include "Geometry.h"
+#include "../Transform.h"
+// rkcommon
+#include "rkcommon/tasking/parallel_for.h"
 
 namespace ospray {
 namespace sg {
@@ -61,6 +64,9 @@ void Geometry::postCommit()
     model->setParam("invertNormals", val);
   }
 
+  if (sgGeomId)
+    model->setParam("id", sgGeomId);
+
   model->commit();
 
   std::string type =
@@ -73,6 +79,29 @@ void Geometry::postCommit()
     group = nullptr;
 }
 
+void Geometry::cloneValueFrom(const Node &source)
+{
+  OSPNode::cloneValueFrom(source);
+
+  // The shared Data children may reference the source's arrays, which are
+  // kept alive with it
+  const auto &geom = static_cast<const Geometry &>(source);
+  arraysOwner = geom.arraysOwner ? geom.arraysOwner
+      : std::static_pointer_cast<const Geometry>(geom.shared_from_this());
+
+  // A skinned clone follows the same skeleton, into its own vertices
+  skin = geom.skin;
+  skeletonRoot = geom.skeletonRoot;
+  weightsPerVertex = geom.weightsPerVertex;
+  skinnedPositions = geom.skinnedPositions;
+  skinnedNormals = geom.skinnedNormals;
+}
+
+const Geometry &Geometry::arrays() const
+{
+  return arraysOwner ? *arraysOwner : *this;
+}
+
 bool Geometry::checkAndNormalizeWeights()
 {
   bool warn = false;
@@ -105,5 +134,174 @@ bool Geometry::checkAndNormalizeWeights()
   return warn;
 }
 
+// Skinning /////////////////////////////////////////////////////////////////
+
+void Skin::updatePalette(size_t frame)
+{
+  if (paletteFrame == frame)
+    return;
+  paletteFrame = frame;
+
+  jointXfms.resize(joints.size());
+  jointEndXfms.resize(joints.size());
+  motionBlur = false;
+
+  for (size_t j = 0; j < joints.size(); ++j) {
+    const auto &joint = static_cast<const Transform &>(*joints[j]);
+    jointXfms[j] = joint.accumulatedXfm * inverseBindMatrices[j];
+    jointEndXfms[j] = joint.accumulatedEndXfm * inverseBindMatrices[j];
+    motionBlur |= joint.motionBlur;
+  }
+}
+
+// Bounds of 'points', reduced from blocks computed in parallel
+static box3f pointBounds(const std::vector<vec3f> &points)
+{
+  constexpr size_t blockSize = 16 * 1024;
+  const size_t numBlocks = (points.size() + blockSize - 1) / blockSize;
+  std::vector<box3f> blockBounds(numBlocks);
+
+  tasking::parallel_for(numBlocks, [&](size_t block) {
+    const size_t begin = block * blockSize;
+    const size_t end = std::min(begin + blockSize, points.size());
+    box3f bounds(empty);
+    for (size_t i = begin; i < end; ++i)
+      bounds.extend(points[i]);
+    blockBounds[block] = bounds;
+  });
+
+  box3f bounds(empty);
+  for (const auto &b : blockBounds)
+    bounds.extend(b);
+  return bounds;
+}
+
+bool Geometry::computeBounds(box3f &bounds)
+{
+  bounds = box3f(empty);
+  if (!child("enable").valueAs<bool>())
+    return true;
+
+  // skinnedPositions are the vertices given to OSPRay, positions may only
+  // hold the bind pose of a skinned mesh
+  const auto &vertices =
+      skinnedPositions.empty() ? arrays().positions : skinnedPositions;
+  const bool perSphereRadius = hasChild("sphere.radius");
+  if (!vertices.empty() && !perSphereRadius) {
+    bounds = pointBounds(vertices);
+    if (hasChild("radius")) {
+      const float radius = child("radius").valueAs<float>();
+      bounds.lower -= vec3f(radius);
+      bounds.upper += vec3f(radius);
+    }
+    return true;
+  }
+
+  // Bounds aren't known before the geometry is committed
+  auto &geom = valueAs<cpp::Geometry>();
+  if (!geom.handle() || subtreeModifiedButNotCommitted())
+    return false;
+
+  bounds = geom.getBounds<box3f>();
+  return true;
+}
+
+// Blends the skinning matrices of the vertices [begin, end), blocks are
+// independent and the inner loops have no branches
+static void skinVertices(size_t begin,
+    size_t end,
+    size_t weightsPerVertex,
+    const uint16_t *joints,
+    const float *weights,
+    const affine3f *xfms,
+    const vec3f *positions,
+    const vec3f *normals,
+    vec3f *skinnedPositions,
+    vec3f *skinnedNormals)
+{
+  for (size_t i = begin; i < end; ++i) {
+    affine3f xfm{zero};
+    const size_t first = i * weightsPerVertex;
+    for (size_t j = first; j < first + weightsPerVertex; ++j)
+      xfm = xfm + weights[j] * xfms[joints[j]];
+
+    skinnedPositions[i] = xfmPoint(xfm, positions[i]);
+    if (skinnedNormals)
+      skinnedNormals[i] = xfmNormal(xfm, normals[i]);
+  }
+}
+
+bool Geometry::updateSkinning(size_t frame)
+{
+  skin->updatePalette(frame);
+
+  // from gltf docu:
+  // final joint matrix = globalTransformOfNodeThatTheMeshIsAttachedTo^-1 *
+  //                         globalTransformOfJointNode(j) *
+  //                         inverseBindMatrixForJoint(j)
+  // As the weights are normalized the inverse root transform is applied to
+  // the palette once instead of to every blended vertex matrix.
+  const auto &root = static_cast<const Transform &>(*skeletonRoot);
+  const affine3f rootInv = rcp(root.accumulatedXfm);
+  const affine3f rootEndInv = rcp(root.accumulatedEndXfm);
+  const bool motionBlur = root.motionBlur || skin->motionBlur;
+
+  const size_t numJoints = skin->joints.size();
+  std::vector<affine3f> xfms(numJoints);
+  std::vector<affine3f> endXfms(motionBlur ? numJoints : 0);
+  for (size_t j = 0; j < numJoints; ++j)
+    xfms[j] = rootInv * skin->jointXfms[j];
+  for (size_t j = 0; j < endXfms.size(); ++j)
+    endXfms[j] = rootEndInv * skin->jointEndXfms[j];
+
+  // A commit of the geometry may have reset its vertices
+  const bool unchanged = lastSkinned > lastCommitted()
+      && motionBlur == skinnedMotionBlur && xfms == skinningXfms
+      && endXfms == skinningEndXfms;
+  if (unchanged)
+    return false;
+
+  skinningXfms.swap(xfms);
+  skinningEndXfms.swap(endXfms);
+  skinnedMotionBlur = motionBlur;
+
+  const bool hasNormals = !skinnedNormals.empty();
+  skinnedEndPositions.resize(motionBlur ? skinnedPositions.size() : 0);
+  skinnedEndNormals.resize(motionBlur ? skinnedNormals.size() : 0);
+
+  // Blocks of vertices are large enough to amortize the task overhead
+  const auto &src = arrays();
+  tasking::parallel_in_blocks_of<1024>(
+      src.positions.size(), [&](size_t begin, size_t end) {
+        skinVertices(begin,
+            end,
+            weightsPerVertex,
+            src.joints.data(),
+            src.weights.data(),
+            skinningXfms.data(),
+            src.positions.data(),
+            src.normals.data(),
+            skinnedPositions.data(),
+            hasNormals ? skinnedNormals.data() : nullptr);
+        if (motionBlur) {
+          skinVertices(begin,
+              end,
+              weightsPerVertex,
+              src.joints.data(),
+              src.weights.data(),
+              skinningEndXfms.data(),
+              src.positions.data(),
+              src.normals.data(),
+              skinnedEndPositions.data(),
+              hasNormals ? skinnedEndNormals.data() : nullptr);
+        }
+      });
+
+  lastSkinned.renew();
+  // skinning moves the vertices without modifying the node
+  invalidateBounds();
+  return true;
+}
+
 } // namespace sg
 } // namespace ospray
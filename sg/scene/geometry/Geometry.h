@@ -15,6 +15,20 @@ struct OSPSG_INTERFACE Skin
 {
   std::vector<affine3f> inverseBindMatrices;
   std::vector<NodePtr> joints;
+
+  // Joint palette: accumulated transform of each joint times its inverse
+  // bind matrix, at shutter open and close
+  std::vector<affine3f> jointXfms;
+  std::vector<affine3f> jointEndXfms;
+  bool motionBlur{false}; // a joint's end transform is different
+
+  // Computes the palette from the joints' accumulated transforms, once per
+  // 'frame' (any id which is unique to a scene traversal) for all meshes
+  // sharing this skin
+  void updatePalette(size_t frame);
+
+ private:
+  size_t paletteFrame{0};
 };
 using SkinPtr = std::shared_ptr<Skin>;
 
@@ -30,6 +44,11 @@ struct OSPSG_INTERFACE Geometry
 
   // skinning
   bool checkAndNormalizeWeights();
+  // Skins positions and normals with the palette of the current frame.
+  // Returns false, leaving the skinned arrays as they are, if neither the
+  // joints nor the geometry changed since the last call.
+  bool updateSkinning(size_t frame);
+  bool skinnedMotionBlur{false}; // skinnedEnd* arrays are valid
   SkinPtr skin;
   NodePtr skeletonRoot;
   size_t weightsPerVertex{0};
@@ -51,6 +70,29 @@ struct OSPSG_INTERFACE Geometry
 
   GroupPtr group{nullptr};
   GeometricModelPtr model{nullptr};
+  // written to the object ID buffer by the model, set by RenderScene. A
+  // geometry shared by several transforms with a geomId has the id of one of
+  // them, picking reports that transform for all of its instances.
+  unsigned int sgGeomId{0};
+
+ protected:
+  // Computed from the vertices when they're kept on this node, otherwise
+  // queried from the committed geometry
+  bool computeBounds(box3f &bounds) override;
+
+  // A clone has its own OSPRay geometry, model and children (eg. material),
+  // the Data children and the vertex arrays are shared with the source
+  void cloneValueFrom(const Node &source) override;
+
+ private:
+  // Node holding the vertex arrays, the source of a clone
+  const Geometry &arrays() const;
+  std::shared_ptr<const Geometry> arraysOwner;
+
+  // skinning matrices (palette relative to the skeleton root) last applied
+  std::vector<affine3f> skinningXfms;
+  std::vector<affine3f> skinningEndXfms;
+  TimeStamp lastSkinned;
 };
 
 } // namespace sg
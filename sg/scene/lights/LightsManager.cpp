@@ -3,6 +3,8 @@
 
 #include "LightsManager.h"
 #include "Light.h"
+// stl
+#include <algorithm>
 
 namespace ospray {
 namespace sg {
@@ -21,8 +23,7 @@ NodeType LightsManager::type() const
 
 bool LightsManager::lightExists(std::string name)
 {
-  auto found = std::find(lightNames.begin(), lightNames.end(), name);
-  return (found != lightNames.end());
+  return lightIndex.find(name) != lightIndex.end();
 }
 
 // Add a light node (main entry)
@@ -39,8 +40,10 @@ bool LightsManager::addLight(NodePtr light)
   if (hasChild("default-ambient") && rmDefaultLight)
     removeLight("default-ambient");
 
+  lightIndex[light->name()] = lightNames.size();
   lightNames.push_back(light->name());
   add(light);
+  membershipChanged = true;
   return true;
 }
 
@@ -81,32 +84,79 @@ bool LightsManager::removeLight(std::string name)
   child(name).child("visible") = false;
 
   remove(name);
-  auto found = std::find(lightNames.begin(), lightNames.end(), name);
-  lightNames.erase(found);
+  membershipChanged = true;
+
+  // Lights keep their order, the removed one leaves an empty name behind
+  auto found = lightIndex.find(name);
+  lightNames[found->second].clear();
+  lightIndex.erase(found);
+  numRemoved++;
+  if (numRemoved > 16 && numRemoved > lightNames.size() / 2)
+    compactLightNames();
 
   return true;
 }
 
+void LightsManager::compactLightNames()
+{
+  lightNames.erase(std::remove(lightNames.begin(), lightNames.end(), ""),
+      lightNames.end());
+  for (size_t i = 0; i < lightNames.size(); ++i)
+    lightIndex[lightNames[i]] = i;
+  numRemoved = 0;
+}
+
 void LightsManager::clear()
 {
   // removeLight modifies the lightNames vector, make a copy.
   auto tempNames = lightNames;
   for (auto &name : tempNames) {
-    removeLight(name);
+    if (!name.empty())
+      removeLight(name);
   }
 
   // Re-add the default-ambient light when clearing lights
   addLight("default-ambient", "ambient");
 }
 
+// Lights that are in a group aren't on the world lights list also
+bool LightsManager::isWorldLight(Node &light)
+{
+  return !static_cast<Light &>(light).inGroup
+      && light.child("enable").valueAs<bool>();
+}
+
 void LightsManager::preCommit()
 {
+  // Of the lights already listed, only modified ones can have been enabled
+  // or disabled
+  if (!membershipChanged) {
+    for (auto *node : modifiedChildren()) {
+      if (node->type() == NodeType::LIGHT
+          && isWorldLight(*node) != (worldLights.count(node) != 0)) {
+        membershipChanged = true;
+        break;
+      }
+    }
+  }
+
+  if (!membershipChanged)
+    return;
+
   cppWorldLightObjects.clear();
+  worldLights.clear();
+  for (auto &name : lightNames) {
+    if (name.empty())
+      continue;
+    auto &light = child(name);
+    if (isWorldLight(light)) {
+      cppWorldLightObjects.emplace_back(light.valueAs<cpp::Light>());
+      worldLights.insert(&light);
+    }
+  }
 
-  // Don't add lights that are in a group to the world lights list also
-  for (auto &name : lightNames)
-    if (!child(name).nodeAs<Light>()->inGroup && child(name).child("enable").valueAs<bool>())
-        cppWorldLightObjects.emplace_back(child(name).valueAs<cpp::Light>());
+  membershipChanged = false;
+  placementPending = true;
 }
 
 void LightsManager::postCommit()
@@ -120,10 +170,17 @@ void LightsManager::postCommit()
 // On a change of world or lightsManager, set the new lights list on the world
 void LightsManager::updateWorld(World &world)
 {
-  if (!cppWorldLightObjects.empty())
-    world.handle().setParam("light", cpp::CopiedData(cppWorldLightObjects));
-  else
-    world.handle().removeParam("light");
+  // The list is only set again when lights were added, removed, enabled or
+  // disabled, changed parameters are picked up by committing the lights
+  if (placementPending || world.handle().handle() != placedWorld.handle()) {
+    if (!cppWorldLightObjects.empty())
+      world.handle().setParam("light", cpp::CopiedData(cppWorldLightObjects));
+    else
+      world.handle().removeParam("light");
+
+    placedWorld = world.handle();
+    placementPending = false;
+  }
 
   world.handle().commit();
 }
@@ -41,13 +41,28 @@ struct OSPSG_INTERFACE LightsManager
   bool rmDefaultLight{true};
 
  protected:
+  // in the order the lights were added, removed ones are left empty until
+  // compacted
   std::vector<std::string> lightNames;
+  size_t numRemoved{0};
+  // position of each light in lightNames
+  std::unordered_map<std::string, size_t> lightIndex;
+
+  // Lights on the world's list. It's only rebuilt when lights were added or
+  // removed, or when a modified light was enabled or disabled.
   std::vector<cpp::Light> cppWorldLightObjects;
+  std::unordered_set<const Node *> worldLights;
+  bool membershipChanged{true};
+  // the list wasn't set on the world since it was rebuilt
+  bool placementPending{true};
+  cpp::World placedWorld{nullptr};
 
   virtual void preCommit() override;
   virtual void postCommit() override;
 
  private:
+  static bool isWorldLight(Node &light);
+  void compactLightNames();
 };
 
 } // namespace sg
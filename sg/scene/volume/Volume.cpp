@@ -45,6 +45,21 @@ NodeType Volume::type() const
   return NodeType::VOLUME;
 }
 
+bool Volume::computeBounds(box3f &bounds)
+{
+  bounds = box3f(empty);
+  if (!child("enable").valueAs<bool>())
+    return true;
+
+  // Bounds aren't known before the volume is committed
+  auto &vol = valueAs<cpp::Volume>();
+  if (!vol.handle() || subtreeModifiedButNotCommitted())
+    return false;
+
+  bounds = vol.getBounds<box3f>();
+  return true;
+}
+
 template <typename T>
 void Volume::loadVoxels(FILE *file, const vec3i dimensions)
 {
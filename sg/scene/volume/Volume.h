@@ -47,6 +47,10 @@ struct OSPSG_INTERFACE Volume : public OSPNode<cpp::Volume, NodeType::VOLUME>
 
   int groupIndex{-1};
 
+ protected:
+  // Queried from the committed volume
+  bool computeBounds(box3f &bounds) override;
+
  private:
   bool fileLoaded{false};
 
@@ -0,0 +1,444 @@
+// Copyright 2009 Intel Corporation
+// SPDX-License-Identifier: Apache-2.0
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <fstream>
+#include <new>
+#ifdef __linux__
+#include <unistd.h>
+#endif
+
+#include "sg/Node.h"
+#include "sg/SearchIndex.h"
+#include "sg/scene/Transform.h"
+#include "sg/visitors/Search.h"
+
+using namespace ospray::sg;
+
+// Heap allocation counting ///////////////////////////////////////////////////
+
+static std::atomic<size_t> numHeapAllocations{0};
+
+void *operator new(size_t size)
+{
+  numHeapAllocations++;
+  if (void *ptr = std::malloc(size ? size : 1))
+    return ptr;
+  throw std::bad_alloc();
+}
+
+void operator delete(void *ptr) noexcept
+{
+  std::free(ptr);
+}
+
+void operator delete(void *ptr, size_t) noexcept
+{
+  std::free(ptr);
+}
+
+// Generated test scenes //////////////////////////////////////////////////////
+
+// A world-like tree: 'numBranches' transforms each holding 'numLeaves'
+// parameter nodes, ie. numBranches * (numLeaves + 1) + 1 nodes.
+static NodePtr generateTree(int numBranches, int numLeaves)
+{
+  auto root = createNode("root");
+  for (int i = 0; i < numBranches; ++i) {
+    auto &branch = root->createChild("branch_" + std::to_string(i));
+    for (int j = 0; j < numLeaves; ++j)
+      branch.createChild("leaf_" + std::to_string(j), "float", float(j));
+  }
+  return root;
+}
+
+// Commit benchmarks //////////////////////////////////////////////////////////
+
+static void commitSingleEdit(benchmark::State &state, CommitMode mode)
+{
+  auto root = generateTree(int(state.range(0)), 8);
+  root->commit();
+
+  auto &leaf = root->child("branch_" + std::to_string(state.range(0) / 2))
+                   .child("leaf_4");
+  float value = 0.f;
+
+  for (auto _ : state) {
+    leaf = value++;
+    root->commit(mode);
+  }
+
+  state.counters["nodes"] = state.range(0) * 9 + 1;
+}
+
+static void BM_CommitFull(benchmark::State &state)
+{
+  commitSingleEdit(state, CommitMode::FULL);
+}
+
+static void BM_CommitDirtyPaths(benchmark::State &state)
+{
+  commitSingleEdit(state, CommitMode::DIRTY_PATHS);
+}
+
+BENCHMARK(BM_CommitFull)->RangeMultiplier(10)->Range(100, 100000);
+BENCHMARK(BM_CommitDirtyPaths)->RangeMultiplier(10)->Range(100, 100000);
+
+// Child lookup benchmarks ////////////////////////////////////////////////////
+
+static NodePtr generateWideNode(int numChildren)
+{
+  auto root = createNode("root");
+  for (int i = 0; i < numChildren; ++i)
+    root->createChild("child_" + std::to_string(i));
+  return root;
+}
+
+static void BM_ChildLookup(benchmark::State &state)
+{
+  const int numChildren = int(state.range(0));
+  auto root = generateWideNode(numChildren);
+
+  std::vector<std::string> names;
+  for (int i = 0; i < numChildren; i += std::max(1, numChildren / 64))
+    names.push_back("child_" + std::to_string(i));
+
+  size_t n = 0;
+  for (auto _ : state) {
+    auto &c = root->child(names[n++ % names.size()]);
+    benchmark::DoNotOptimize(&c);
+  }
+}
+
+static void BM_HasChildMissing(benchmark::State &state)
+{
+  auto root = generateWideNode(int(state.range(0)));
+
+  for (auto _ : state)
+    benchmark::DoNotOptimize(root->hasChild("not_a_child"));
+}
+
+static void BM_ChildAddRemove(benchmark::State &state)
+{
+  auto root = generateWideNode(int(state.range(0)));
+  auto extra = createNode("extra");
+
+  for (auto _ : state) {
+    root->add(extra);
+    root->remove("extra");
+  }
+}
+
+BENCHMARK(BM_ChildLookup)->RangeMultiplier(10)->Range(10, 100000);
+BENCHMARK(BM_HasChildMissing)->RangeMultiplier(10)->Range(10, 100000);
+BENCHMARK(BM_ChildAddRemove)->RangeMultiplier(10)->Range(10, 100000);
+
+// Value access benchmarks ////////////////////////////////////////////////////
+
+// Transform-like nodes holding the parameters RenderScene reads per node
+static NodePtr generateXfmTree(int numXfms)
+{
+  auto root = createNode("root");
+  for (int i = 0; i < numXfms; ++i) {
+    auto &xfm = root->createChild("xfm_" + std::to_string(i));
+    xfm.createChild("rotation", "quaternionf", quaternionf(1.f));
+    xfm.createChild("scale", "vec3f", vec3f(1.f));
+    xfm.createChild("translation", "vec3f", vec3f(float(i)));
+    xfm.createChild("visible", "bool", true);
+  }
+  return root;
+}
+
+template <typename READ_FCN>
+struct ReadXfmParams : public Visitor
+{
+  ReadXfmParams(READ_FCN _read) : read(_read) {}
+
+  bool operator()(Node &node, TraversalContext &ctx) override
+  {
+    if (ctx.level == 1)
+      read(node);
+    return ctx.level == 0;
+  }
+
+  READ_FCN read;
+};
+
+template <typename READ_FCN>
+static void traverseReading(benchmark::State &state, READ_FCN read)
+{
+  auto root = generateXfmTree(int(state.range(0)));
+
+  for (auto _ : state)
+    root->traverse(ReadXfmParams<READ_FCN>(read));
+
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+static void BM_TraverseReadAnyCopy(benchmark::State &state)
+{
+  traverseReading(state, [](Node &node) {
+    auto r = node["rotation"].value().get<quaternionf>();
+    auto s = node["scale"].value().get<vec3f>();
+    auto t = node["translation"].value().get<vec3f>();
+    auto v = node["visible"].value().get<bool>();
+    benchmark::DoNotOptimize(r);
+    benchmark::DoNotOptimize(s);
+    benchmark::DoNotOptimize(t);
+    benchmark::DoNotOptimize(v);
+  });
+}
+
+static void BM_TraverseReadValueAs(benchmark::State &state)
+{
+  traverseReading(state, [](Node &node) {
+    auto &r = node["rotation"].valueAs<quaternionf>();
+    auto &s = node["scale"].valueAs<vec3f>();
+    auto &t = node["translation"].valueAs<vec3f>();
+    auto v  = node["visible"].valueAs<bool>();
+    benchmark::DoNotOptimize(r);
+    benchmark::DoNotOptimize(s);
+    benchmark::DoNotOptimize(t);
+    benchmark::DoNotOptimize(v);
+  });
+}
+
+static void BM_TraverseReadTyped(benchmark::State &state)
+{
+  traverseReading(state, [](Node &node) {
+    auto &r = node.childAs<QuaternionfNode>("rotation").value();
+    auto &s = node.childAs<Vec3fNode>("scale").value();
+    auto &t = node.childAs<Vec3fNode>("translation").value();
+    auto v  = node.childAs<BoolNode>("visible").value();
+    benchmark::DoNotOptimize(r);
+    benchmark::DoNotOptimize(s);
+    benchmark::DoNotOptimize(t);
+    benchmark::DoNotOptimize(v);
+  });
+}
+
+BENCHMARK(BM_TraverseReadAnyCopy)->RangeMultiplier(10)->Range(100, 100000);
+BENCHMARK(BM_TraverseReadValueAs)->RangeMultiplier(10)->Range(100, 100000);
+BENCHMARK(BM_TraverseReadTyped)->RangeMultiplier(10)->Range(100, 100000);
+
+// Parallel traversal benchmarks //////////////////////////////////////////////
+
+static void BM_SearchSequential(benchmark::State &state)
+{
+  auto root = generateTree(int(state.range(0)), 8);
+
+  for (auto _ : state) {
+    SearchResults results;
+    root->traverse<Search>("leaf_4", NodeType::GENERIC, results);
+    benchmark::DoNotOptimize(results.data());
+  }
+
+  state.counters["nodes"] = state.range(0) * 9 + 1;
+}
+
+static void BM_SearchParallel(benchmark::State &state)
+{
+  auto root = generateTree(int(state.range(0)), 8);
+
+  for (auto _ : state) {
+    SearchResults results;
+    root->traverseParallel<Search>("leaf_4", NodeType::GENERIC, results);
+    benchmark::DoNotOptimize(results.data());
+  }
+
+  state.counters["nodes"] = state.range(0) * 9 + 1;
+}
+
+// The same query answered by the index
+static void BM_SearchIndexed(benchmark::State &state)
+{
+  auto root = generateTree(int(state.range(0)), 8);
+  SearchIndex::enable(*root);
+
+  for (auto _ : state) {
+    auto results = SearchIndex::find(*root, "leaf_4");
+    benchmark::DoNotOptimize(results.data());
+  }
+
+  SearchIndex::disable();
+  state.counters["nodes"] = state.range(0) * 9 + 1;
+}
+
+// ... and a selective query, as typed into the search widget
+static void BM_SearchIndexedSelective(benchmark::State &state)
+{
+  auto root = generateTree(int(state.range(0)), 8);
+  SearchIndex::enable(*root);
+  const auto term = "branch_" + std::to_string(state.range(0) / 2);
+
+  for (auto _ : state) {
+    auto results = SearchIndex::find(*root, term);
+    benchmark::DoNotOptimize(results.data());
+  }
+
+  SearchIndex::disable();
+  state.counters["nodes"] = state.range(0) * 9 + 1;
+}
+
+static void BM_SearchSelective(benchmark::State &state)
+{
+  auto root = generateTree(int(state.range(0)), 8);
+  const auto term = "branch_" + std::to_string(state.range(0) / 2);
+
+  for (auto _ : state) {
+    SearchResults results;
+    root->traverseParallel<Search>(term, NodeType::GENERIC, results);
+    benchmark::DoNotOptimize(results.data());
+  }
+
+  state.counters["nodes"] = state.range(0) * 9 + 1;
+}
+
+BENCHMARK(BM_SearchSequential)->RangeMultiplier(10)->Range(1000, 100000);
+BENCHMARK(BM_SearchParallel)->RangeMultiplier(10)->Range(1000, 100000);
+BENCHMARK(BM_SearchIndexed)->RangeMultiplier(10)->Range(1000, 100000);
+BENCHMARK(BM_SearchSelective)->RangeMultiplier(10)->Range(1000, 100000);
+BENCHMARK(BM_SearchIndexedSelective)->RangeMultiplier(10)->Range(1000, 100000);
+
+// Node creation benchmarks ///////////////////////////////////////////////////
+
+static void BM_CreateNodeLoop(benchmark::State &state)
+{
+  const size_t count = size_t(state.range(0));
+  size_t allocations = 0;
+
+  for (auto _ : state) {
+    auto before = numHeapAllocations.load();
+    std::vector<NodePtr> nodes;
+    for (size_t i = 0; i < count; ++i)
+      nodes.push_back(createNode("leaf_" + std::to_string(i), "float"));
+    allocations += numHeapAllocations.load() - before;
+  }
+
+  state.counters["allocs/node"] =
+      double(allocations) / (state.iterations() * count);
+}
+
+static void BM_CreateNodesBulk(benchmark::State &state)
+{
+  const size_t count = size_t(state.range(0));
+  size_t allocations = 0;
+
+  for (auto _ : state) {
+    auto before = numHeapAllocations.load();
+    auto nodes = createNodes(count, "float", "leaf");
+    allocations += numHeapAllocations.load() - before;
+  }
+
+  state.counters["allocs/node"] =
+      double(allocations) / (state.iterations() * count);
+}
+
+BENCHMARK(BM_CreateNodeLoop)->RangeMultiplier(10)->Range(100, 100000);
+BENCHMARK(BM_CreateNodesBulk)->RangeMultiplier(10)->Range(100, 100000);
+
+// Transform benchmarks ///////////////////////////////////////////////////////
+
+static std::vector<std::shared_ptr<Transform>> generateTransforms(int count)
+{
+  std::vector<std::shared_ptr<Transform>> xfms;
+  for (int i = 0; i < count; ++i) {
+    xfms.push_back(
+        createNodeAs<Transform>("xfm_" + std::to_string(i), "transform"));
+    xfms.back()->child("translation") = vec3f(float(i));
+    xfms.back()->updateLocalXfm();
+  }
+  return xfms;
+}
+
+// What RenderScene pays per transform and frame when nothing moved
+static void BM_TransformLocalXfmUnchanged(benchmark::State &state)
+{
+  auto xfms = generateTransforms(int(state.range(0)));
+
+  for (auto _ : state) {
+    for (auto &xfm : xfms) {
+      xfm->updateLocalXfm();
+      benchmark::DoNotOptimize(xfm->localXfm);
+    }
+  }
+}
+
+// ... and when every transform is animated
+static void BM_TransformLocalXfmAnimated(benchmark::State &state)
+{
+  auto xfms = generateTransforms(int(state.range(0)));
+  float t = 0.f;
+
+  for (auto _ : state) {
+    t += 1.f;
+    for (auto &xfm : xfms) {
+      xfm->child("translation") = vec3f(t);
+      xfm->updateLocalXfm();
+      benchmark::DoNotOptimize(xfm->localXfm);
+    }
+  }
+}
+
+BENCHMARK(BM_TransformLocalXfmUnchanged)
+    ->RangeMultiplier(10)
+    ->Range(100, 100000);
+BENCHMARK(BM_TransformLocalXfmAnimated)
+    ->RangeMultiplier(10)
+    ->Range(100, 100000);
+
+// Node footprint //////////////////////////////////////////////////////////////
+
+// Resident set size in bytes, 0 where it can't be queried
+static size_t residentBytes()
+{
+#ifdef __linux__
+  size_t totalPages = 0, residentPages = 0;
+  std::ifstream statm("/proc/self/statm");
+  if (statm >> totalPages >> residentPages)
+    return residentPages * size_t(sysconf(_SC_PAGESIZE));
+#endif
+  return 0;
+}
+
+// Memory per node of a tree of described, ranged parameter nodes, as the
+// importers and the UI parameter nodes create them
+static void BM_NodeFootprint(benchmark::State &state)
+{
+  const int numBranches = int(state.range(0));
+  const int numLeaves = 8;
+  double rssPerNode = 0.0;
+  size_t numNodes = 0;
+
+  for (auto _ : state) {
+    auto before = residentBytes();
+    auto root = createNode("root");
+    for (int i = 0; i < numBranches; ++i) {
+      auto &branch = root->createChild("branch_" + std::to_string(i));
+      for (int j = 0; j < numLeaves; ++j) {
+        auto &leaf = branch.createChild(
+            "leaf_" + std::to_string(j), "float", "leaf parameter", float(j));
+        leaf.setMinMax(0.f, 1.f);
+      }
+    }
+    numNodes = size_t(numBranches) * (numLeaves + 1) + 1;
+    rssPerNode += double(residentBytes() - before) / numNodes;
+    benchmark::DoNotOptimize(root);
+  }
+
+  state.counters["sizeof(Node)"] = sizeof(Node);
+  state.counters["sizeof(FloatNode)"] = sizeof(FloatNode);
+  state.counters["RSS bytes/node"] = rssPerNode / state.iterations();
+  state.counters["metadata records"] = NodeMetadata::numInterned();
+}
+
+BENCHMARK(BM_NodeFootprint)
+    ->RangeMultiplier(10)
+    ->Range(1000, 100000)
+    ->Iterations(1);
+
+BENCHMARK_MAIN();
@@ -5,10 +5,17 @@
 
 #define protected public
 #include "sg/Node.h"
+#include "sg/SearchIndex.h"
+#include "sg/scene/Transform.h"
+#include "sg/scene/World.h"
+#include "sg/scene/lights/Light.h"
+#include "sg/visitors/Search.h"
 #undef protected
 
 using namespace ospray::sg;
 
+#include <algorithm>
+#include <thread>
 #include <type_traits>
 
 SCENARIO("sg::createNode()")
@@ -56,6 +63,65 @@ SCENARIO("sg::createNode()")
       REQUIRE(node.valueAs<float>() == asFloatNode->value());
     }
   }
+
+  GIVEN("The registered node types")
+  {
+    auto subtypes = registeredNodeTypes();
+
+    THEN("Node types of the library are registered when it is loaded")
+    {
+      REQUIRE(std::is_sorted(subtypes.begin(), subtypes.end()));
+      REQUIRE(std::binary_search(subtypes.begin(), subtypes.end(), "Node"));
+      REQUIRE(std::binary_search(subtypes.begin(), subtypes.end(), "float"));
+      REQUIRE(std::binary_search(subtypes.begin(), subtypes.end(), "vec3f"));
+    }
+
+    THEN("Unknown node types throw")
+    {
+      REQUIRE_THROWS(createNode("test_node", "not_a_node_type"));
+    }
+  }
+
+  GIVEN("A batch of nodes from sg::createNodes()")
+  {
+    auto nodes = createNodes(1000, "float", "leaf");
+
+    THEN("All nodes are created with their indexed names")
+    {
+      REQUIRE(nodes.size() == 1000);
+      REQUIRE(nodes[0]->name() == "leaf_0");
+      REQUIRE(nodes[999]->name() == "leaf_999");
+      REQUIRE(nodes[42]->subType() == "float");
+      REQUIRE(dynamic_cast<FloatNode *>(nodes[42].get()) != nullptr);
+    }
+
+    THEN("The nodes come from the subtype's pool")
+    {
+      auto *pool = getNodePool("float");
+      REQUIRE(pool->numAllocated() >= 1000);
+
+      auto allocated = pool->numAllocated();
+      nodes.clear();
+      REQUIRE(pool->numAllocated() == allocated - 1000);
+    }
+  }
+
+  GIVEN("Many pooled nodes released at once")
+  {
+    auto *pool = getNodePool("float");
+    auto nodes = createNodes(20000, "float", "leaf");
+    auto numSlabs = pool->numSlabs();
+
+    WHEN("The nodes are destroyed")
+    {
+      nodes.clear();
+
+      THEN("Their empty slabs are returned to the heap")
+      {
+        REQUIRE(pool->numSlabs() < numSlabs);
+      }
+    }
+  }
 }
 
 SCENARIO("sg::Node interface")
@@ -304,5 +370,760 @@ SCENARIO("sg::Node_T<> interface")
       float value = floatNode;
       REQUIRE(value == 1.f);
     }
+
+    THEN("The generic Any interface sees the inline value")
+    {
+      Node &node = floatNode;
+      REQUIRE(node.value() == Any(1.f));
+      REQUIRE(node.valueAs<float>() == 1.f);
+
+      node.valueAs<float>() = 3.f;
+      REQUIRE(floatNode.value() == 3.f);
+      REQUIRE(node.value() == Any(3.f));
+    }
+
+    THEN("A value of a different type is kept in the Any")
+    {
+      Node &node = floatNode;
+      node.setValue(Any(std::string("text")));
+
+      REQUIRE(node.valueIsType<std::string>());
+      REQUIRE(!node.valueIsType<float>());
+      REQUIRE(node.valueAs<std::string>() == "text");
+
+      floatNode = 4.f;
+      REQUIRE(node.valueIsType<float>());
+      REQUIRE(floatNode.value() == 4.f);
+    }
+  }
+}
+
+SCENARIO("sg::Node commit along dirty paths")
+{
+  GIVEN("A committed tree with many children")
+  {
+    auto root_ptr = createNode("root");
+    auto &root    = *root_ptr;
+
+    for (int i = 0; i < 16; ++i) {
+      auto &branch = root.createChild("branch" + std::to_string(i));
+      branch.createChild("leaf", "Node", "leaf", i);
+    }
+
+    root.commit();
+
+    auto &dirtyBranch = root["branch3"];
+    auto &cleanBranch = root["branch7"];
+    TimeStamp cleanCommitted = cleanBranch.lastCommitted();
+
+    WHEN("A single leaf is modified and committed with CommitMode::DIRTY_PATHS")
+    {
+      dirtyBranch["leaf"] = 42;
+      root.commit(CommitMode::DIRTY_PATHS);
+
+      THEN("The modified path is committed")
+      {
+        REQUIRE(!root.isModified());
+        REQUIRE(!dirtyBranch.isModified());
+        REQUIRE(!dirtyBranch["leaf"].isModified());
+      }
+
+      THEN("Untouched subtrees are not committed again")
+      {
+        REQUIRE(cleanBranch.lastCommitted() == cleanCommitted);
+      }
+    }
+
+    WHEN("A modified subtree is added and committed with CommitMode::DIRTY_PATHS")
+    {
+      auto added_ptr = createNode("added");
+      auto &added    = added_ptr->createChild("leaf", "Node", "leaf", 1);
+      dirtyBranch.add(added_ptr);
+      root.commit(CommitMode::DIRTY_PATHS);
+
+      THEN("The added subtree is committed")
+      {
+        REQUIRE(!added_ptr->isModified());
+        REQUIRE(!added.isModified());
+        REQUIRE(!root.isModified());
+      }
+    }
+  }
+}
+
+SCENARIO("sg::Node modification transactions")
+{
+  GIVEN("A committed parent with two children")
+  {
+    auto parent_ptr = createNode("parent_node");
+    auto &parent    = *parent_ptr;
+    auto &child1    = parent.createChild("child1", "Node", "child", 1);
+    auto &child2    = parent.createChild("child2", "Node", "child", 2);
+
+    parent.commit();
+
+    TimeStamp initialChildrenModified = parent.childrenLastModified();
+
+    WHEN("Children are modified inside a transaction")
+    {
+      {
+        ModificationTransaction transaction;
+        child1 = 10;
+        child2 = 20;
+
+        THEN("Parents are not notified while the transaction is open")
+        {
+          REQUIRE(Node::inTransaction());
+          REQUIRE(parent.childrenLastModified() == initialChildrenModified);
+        }
+      }
+
+      THEN("Parents are notified once the transaction ends")
+      {
+        REQUIRE(!Node::inTransaction());
+        REQUIRE(parent.childrenLastModified() > child1.lastModified());
+        REQUIRE(parent.childrenLastModified() > child2.lastModified());
+        REQUIRE(parent.isModified());
+      }
+
+      THEN("Committing picks up all modifications")
+      {
+        parent.commit(CommitMode::DIRTY_PATHS);
+        REQUIRE(!parent.isModified());
+        REQUIRE(!child1.isModified());
+        REQUIRE(!child2.isModified());
+      }
+    }
+
+    WHEN("Nested transactions are used")
+    {
+      Node::beginTransaction();
+      Node::beginTransaction();
+      child1 = 10;
+      Node::endTransaction();
+
+      THEN("Only the outermost transaction notifies parents")
+      {
+        REQUIRE(parent.childrenLastModified() == initialChildrenModified);
+        Node::endTransaction();
+        REQUIRE(parent.childrenLastModified() > child1.lastModified());
+      }
+    }
+
+    WHEN("A commit happens inside a transaction")
+    {
+      ModificationTransaction transaction;
+      child1 = 10;
+      parent.commit();
+
+      THEN("Pending modifications are committed")
+      {
+        REQUIRE(!child1.isModified());
+        REQUIRE(!parent.isModified());
+      }
+    }
+  }
+}
+
+SCENARIO("sg::Node with a large number of children")
+{
+  GIVEN("A node with more children than the ChildMap index threshold")
+  {
+    auto parent_ptr = createNode("parent_node");
+    auto &parent    = *parent_ptr;
+
+    const int numChildren = int(ChildMap::indexThreshold) * 4;
+    for (int i = 0; i < numChildren; ++i)
+      parent.createChild("child" + std::to_string(i), "Node", "", i);
+
+    THEN("The children are indexed and found by name")
+    {
+      REQUIRE(parent.children().indexed());
+      REQUIRE(parent.children().size() == size_t(numChildren));
+      REQUIRE(parent.hasChild("child17"));
+      REQUIRE(!parent.hasChild("child" + std::to_string(numChildren)));
+      REQUIRE(parent["child17"].valueAs<int>() == 17);
+    }
+
+    WHEN("Most children are removed")
+    {
+      for (int i = 0; i < numChildren; ++i)
+        if (i % 8)
+          parent.remove("child" + std::to_string(i));
+
+      THEN("The remaining children keep their insertion order")
+      {
+        REQUIRE(parent.children().size() == size_t(numChildren / 8));
+        int expected = 0;
+        for (auto &c : parent.children()) {
+          REQUIRE(c.second->valueAs<int>() == expected);
+          expected += 8;
+        }
+      }
+
+      THEN("Removed children are no longer found")
+      {
+        REQUIRE(!parent.hasChild("child1"));
+        REQUIRE(parent.hasChild("child8"));
+      }
+    }
+  }
+}
+
+SCENARIO("sg::Node parallel traversal")
+{
+  GIVEN("A wide tree of nested nodes")
+  {
+    auto root_ptr = createNode("root");
+    auto &root    = *root_ptr;
+
+    for (int i = 0; i < 100; ++i) {
+      auto &branch = root.createChild("branch" + std::to_string(i));
+      for (int j = 0; j < 20; ++j) {
+        auto name = "leaf" + std::to_string(j) + "_" + std::to_string(i);
+        branch.createChild(name);
+      }
+    }
+
+    THEN("A parallel search finds the same nodes in the same order")
+    {
+      SearchResults sequential;
+      SearchResults parallel;
+      root.traverse<Search>("leaf1", NodeType::GENERIC, sequential);
+      root.traverseParallel<Search>("leaf1", NodeType::GENERIC, parallel);
+
+      REQUIRE(parallel.size() == sequential.size());
+      REQUIRE(parallel.size() == 100 * 11);
+      for (size_t i = 0; i < parallel.size(); ++i)
+        REQUIRE(parallel[i].lock() == sequential[i].lock());
+    }
+  }
+}
+
+SCENARIO("sg::Node concurrent structural changes")
+{
+  // Meant to be run under ThreadSanitizer as well
+  GIVEN("Threads building subgraphs which share parameter nodes")
+  {
+    auto root = createNode("root");
+
+    std::vector<NodePtr> shared;
+    for (int i = 0; i < 4; ++i)
+      shared.push_back(createNode("param" + std::to_string(i), "float", 1.f));
+
+    const int numThreads   = 8;
+    const int numPerThread = 200;
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < numThreads; ++t) {
+      threads.emplace_back([&, t]() {
+        for (int i = 0; i < numPerThread; ++i) {
+          auto name = "volume" + std::to_string(t) + "_" + std::to_string(i);
+          auto sub  = createNode(name);
+          for (auto &p : shared)
+            sub->add(p);
+
+          root->add(sub);
+          shared[i % shared.size()]->markAsModified();
+
+          if (i % 2)
+            root->remove(name);
+        }
+      });
+    }
+
+    for (auto &t : threads)
+      t.join();
+
+    THEN("Parent and child links are consistent")
+    {
+      const size_t numSubgraphs = numThreads * numPerThread;
+      REQUIRE(root->children().size() == numSubgraphs / 2);
+      // removed subgraphs are released, unlinking the shared nodes
+      for (auto &p : shared)
+        REQUIRE(p->parents().size() == numSubgraphs / 2);
+
+      for (auto &c : root->children()) {
+        REQUIRE(c.second->parents().size() == 1);
+        REQUIRE(c.second->parents()[0] == root.get());
+      }
+    }
+
+    THEN("Removing the subgraphs releases the shared nodes' parent links")
+    {
+      root->removeAllChildren();
+      REQUIRE(root->children().empty());
+      for (auto &p : shared)
+        REQUIRE(!p->hasParents());
+    }
+  }
+}
+
+SCENARIO("sg::Node cloning")
+{
+  GIVEN("A subtree with parameters and a node reachable twice")
+  {
+    auto root = createNode("root");
+    auto &xfm = root->createChild("xfm", "transform");
+    xfm["translation"] = vec3f(1.f, 2.f, 3.f);
+    auto &param = xfm.createChild("param", "float", 2.f);
+    param.setMinMax(0.f, 10.f);
+
+    auto shared = createNode("shared", "int", 7);
+    root->add(shared);
+    xfm.add(shared);
+
+    WHEN("It is cloned deep")
+    {
+      auto copy = root->clone(CloneMode::DEEP, "copy");
+
+      THEN("Parameters are copied and can be edited independently")
+      {
+        REQUIRE(copy->name() == "copy");
+        REQUIRE(!copy->hasParents());
+        auto &xfmCopy = copy->child("xfm");
+        REQUIRE(&xfmCopy != &xfm);
+        REQUIRE(xfmCopy.subType() == "transform");
+        REQUIRE(xfmCopy["translation"].valueAs<vec3f>() == vec3f(1.f, 2.f, 3.f));
+        REQUIRE(xfmCopy["param"].valueAs<float>() == 2.f);
+        REQUIRE(xfmCopy["param"].maxAs<float>() == 10.f);
+
+        xfmCopy["param"] = 5.f;
+        REQUIRE(param.valueAs<float>() == 2.f);
+      }
+
+      THEN("Nodes with several parents are copied once")
+      {
+        auto &sharedCopy = copy->child("shared");
+        REQUIRE(&sharedCopy != shared.get());
+        REQUIRE(&copy->child("xfm").child("shared") == &sharedCopy);
+        REQUIRE(sharedCopy.parents().size() == 2);
+      }
+    }
+
+    WHEN("A geometry with a material is cloned deep")
+    {
+      auto &geom = xfm.createChild("boxes", "geometry_boxes");
+      geom.createChild("material", "uint32_t", uint32_t(0));
+
+      auto copy = root->clone(CloneMode::DEEP);
+      auto &geomCopy = copy->child("xfm").child("boxes");
+      geomCopy["material"] = uint32_t(1);
+
+      THEN("The copy's material is its own, the Data arrays are shared")
+      {
+        REQUIRE(&geomCopy != &geom);
+        REQUIRE(geom["material"].valueAs<uint32_t>() == 0);
+        REQUIRE(&geomCopy["box"] == &geom["box"]);
+      }
+    }
+
+    WHEN("It is cloned shallow")
+    {
+      auto copy = root->clone(CloneMode::SHALLOW);
+
+      THEN("The copy links to the same children")
+      {
+        REQUIRE(copy->name() == "root");
+        REQUIRE(&copy->child("xfm") == &xfm);
+        REQUIRE(xfm.parents().size() == 2);
+      }
+    }
+  }
+}
+
+SCENARIO("sg::Node shared metadata")
+{
+  GIVEN("Nodes created with the same description and range")
+  {
+    auto a = createNode("a", "float", "a parameter", 1.f);
+    a->setMinMax(0.f, 10.f);
+    auto numRecords = NodeMetadata::numInterned();
+
+    auto b = createNode("b", "float", "a parameter", 2.f);
+    b->setMinMax(0.f, 10.f);
+
+    THEN("They reference one metadata record")
+    {
+      REQUIRE(NodeMetadata::numInterned() == numRecords);
+      REQUIRE(b->description() == "a parameter");
+      REQUIRE(b->maxAs<float>() == 10.f);
+    }
+
+    WHEN("The range of one node changes")
+    {
+      b->setMinMax(0.f, 5.f);
+
+      THEN("The other node keeps its range")
+      {
+        REQUIRE(NodeMetadata::numInterned() == numRecords + 1);
+        REQUIRE(a->maxAs<float>() == 10.f);
+        REQUIRE(b->maxAs<float>() == 5.f);
+        REQUIRE(b->description() == "a parameter");
+      }
+    }
+  }
+}
+
+SCENARIO("sg::Transform local transform")
+{
+  GIVEN("A transform with a translation")
+  {
+    auto xfm = createNodeAs<Transform>("xfm", "transform");
+    xfm->child("translation") = vec3f(1.f, 2.f, 3.f);
+    xfm->updateLocalXfm();
+
+    THEN("The local transform is built from its children")
+    {
+      REQUIRE(xfm->localXfm.p == vec3f(1.f, 2.f, 3.f));
+      REQUIRE(!xfm->localMotionBlur);
+    }
+
+    WHEN("A child changes")
+    {
+      xfm->child("scale") = vec3f(2.f);
+      xfm->updateLocalXfm();
+
+      THEN("The local transform is rebuilt")
+      {
+        REQUIRE(xfm->localXfm.l.vx.x == 2.f);
+        REQUIRE(xfm->localXfm.p == vec3f(1.f, 2.f, 3.f));
+      }
+    }
+
+    WHEN("A child gets an end key")
+    {
+      xfm->child("translation").createChild("endKey", "vec3f", vec3f(4.f));
+      xfm->updateLocalXfm();
+
+      THEN("The end transform diverges")
+      {
+        REQUIRE(xfm->localMotionBlur);
+        REQUIRE(xfm->localEndXfm.p == vec3f(4.f));
+        REQUIRE(xfm->localXfm.p == vec3f(1.f, 2.f, 3.f));
+      }
+    }
+  }
+}
+
+SCENARIO("sg::World instances of a shared subtree")
+{
+  GIVEN("A subtree placed under two transforms")
+  {
+    auto world = createNodeAs<World>("world", "world");
+    auto shared = createNode("shared", "transform");
+    shared->add(createNode("boxes", "geometry_boxes"));
+
+    std::vector<NodePtr> xfms;
+    for (int i = 0; i < 2; ++i) {
+      auto xfm = createNode("xfm" + std::to_string(i), "transform");
+      xfm->child("translation") = vec3f(float(i), 0.f, 0.f);
+      xfm->add(shared);
+      world->add(xfm);
+      xfms.push_back(xfm);
+    }
+    world->render();
+
+    THEN("Each path to the subtree has its instance")
+    {
+      REQUIRE(world->instances.size() == 2);
+    }
+
+    WHEN("One of the transforms moves")
+    {
+      xfms[0]->child("translation") = vec3f(0.f, 1.f, 0.f);
+      world->render();
+
+      THEN("Both instances survive")
+      {
+        REQUIRE(world->instances.size() == 2);
+      }
+    }
+
+    WHEN("The subtree holds in-group lights")
+    {
+      auto light = createNodeAs<Light>("light", "sphere");
+      light->inGroup = true;
+      shared->add(light);
+      world->render();
+
+      THEN("Each path has its light group instance as well")
+      {
+        REQUIRE(world->instances.size() == 4);
+      }
+    }
+  }
+}
+
+SCENARIO("sg::World instance slots")
+{
+  GIVEN("A world of many instances")
+  {
+    auto world = createNodeAs<World>("world", "world");
+    std::vector<NodePtr> xfms;
+    for (int i = 0; i < 10; ++i) {
+      auto xfm = createNode("xfm" + std::to_string(i), "transform");
+      xfm->child("translation") = vec3f(float(i), 0.f, 0.f);
+      xfm->add(createNode("boxes", "geometry_boxes"));
+      world->add(xfm);
+      xfms.push_back(xfm);
+    }
+    world->render();
+
+    WHEN("Most of them are removed")
+    {
+      for (int i = 2; i < 10; ++i)
+        world->remove(xfms[i]);
+      world->render();
+
+      THEN("The slots of the removed ones are dropped")
+      {
+        REQUIRE(world->instances.size() == 2);
+        REQUIRE(world->instances.numSlots() == 2);
+      }
+
+      THEN("The moved instances are still updated in place")
+      {
+        xfms[1]->child("translation") = vec3f(0.f, 1.f, 0.f);
+        world->render();
+        REQUIRE(world->instances.size() == 2);
+        REQUIRE(world->instances.numSlots() == 2);
+      }
+    }
+  }
+}
+
+// A node with fixed bounds, counting how often they're computed
+struct BoundedNode : public Node
+{
+  BoundedNode()
+  {
+    createChild("param", "float", 1.f);
+  }
+
+  bool computeBounds(box3f &bounds) override
+  {
+    computed++;
+    bounds = box;
+    return true;
+  }
+
+  box3f box{vec3f(0.f), vec3f(1.f)};
+  int computed{0};
+};
+
+SCENARIO("sg::Node cached bounds")
+{
+  GIVEN("A bounded node below a transform")
+  {
+    auto root = createNode("root");
+    auto xfm = createNodeAs<Transform>("xfm", "transform");
+    auto leaf = std::make_shared<BoundedNode>();
+    root->add(xfm);
+    xfm->add(leaf, "leaf");
+
+    auto bounds = root->bounds();
+
+    THEN("The bounds are those of the node")
+    {
+      REQUIRE(bounds.lower == vec3f(0.f));
+      REQUIRE(bounds.upper == vec3f(1.f));
+      REQUIRE(leaf->computed == 1);
+    }
+
+    WHEN("The bounds are requested again")
+    {
+      root->bounds();
+
+      THEN("They come from the cache")
+      {
+        REQUIRE(leaf->computed == 1);
+      }
+    }
+
+    WHEN("The transform moves")
+    {
+      xfm->child("translation") = vec3f(1.f, 0.f, 0.f);
+      bounds = root->bounds();
+
+      THEN("The bounds move without computing the node's again")
+      {
+        REQUIRE(bounds.lower == vec3f(1.f, 0.f, 0.f));
+        REQUIRE(bounds.upper == vec3f(2.f, 1.f, 1.f));
+        REQUIRE(leaf->computed == 1);
+      }
+    }
+
+    WHEN("The node is modified")
+    {
+      leaf->box = box3f(vec3f(-1.f), vec3f(1.f));
+      leaf->child("param") = 2.f;
+      bounds = root->bounds();
+
+      THEN("Its bounds are computed again")
+      {
+        REQUIRE(bounds.lower == vec3f(-1.f));
+        REQUIRE(leaf->computed == 2);
+      }
+    }
+
+    WHEN("The node is modified inside a transaction")
+    {
+      ModificationTransaction transaction;
+      leaf->box = box3f(vec3f(-1.f), vec3f(1.f));
+      leaf->child("param") = 2.f;
+      bounds = root->bounds();
+
+      THEN("Its bounds are computed again before the transaction ends")
+      {
+        REQUIRE(Node::inTransaction());
+        REQUIRE(bounds.lower == vec3f(-1.f));
+        REQUIRE(leaf->computed == 2);
+      }
+    }
+
+    WHEN("The transform is hidden")
+    {
+      xfm->child("visible") = false;
+
+      THEN("The bounds are empty")
+      {
+        REQUIRE(root->bounds().empty());
+      }
+    }
+
+    WHEN("The node's cache is invalidated")
+    {
+      leaf->invalidateBounds();
+      root->bounds();
+
+      THEN("The bounds are computed again")
+      {
+        REQUIRE(leaf->computed == 2);
+      }
+    }
+  }
+}
+
+// Nodes of 'results' in a comparable order
+static std::vector<NodePtr> sorted(const SearchResults &results)
+{
+  std::vector<NodePtr> nodes;
+  for (auto &r : results)
+    nodes.push_back(r.lock());
+  std::sort(nodes.begin(), nodes.end());
+  return nodes;
+}
+
+SCENARIO("sg::SearchIndex")
+{
+  GIVEN("An indexed tree")
+  {
+    auto root = createNode("root");
+    for (int i = 0; i < 10; ++i) {
+      auto &branch = root->createChild("branch" + std::to_string(i));
+      for (int j = 0; j < 10; ++j)
+        branch.createChild("leaf" + std::to_string(j), "float", float(j));
+    }
+
+    // indexing is global, don't leave it on for other tests
+    struct ScopedIndex
+    {
+      ScopedIndex(Node &root)
+      {
+        SearchIndex::enable(root);
+      }
+      ~ScopedIndex()
+      {
+        SearchIndex::disable();
+      }
+    } scopedIndex(*root);
+
+    REQUIRE(SearchIndex::size() == 110);
+
+    THEN("It finds what the Search visitor finds")
+    {
+      for (std::string term : {"leaf1", "eaf", "af", "branch3", "x", ""}) {
+        SearchResults visited;
+        root->traverse<Search>(term, NodeType::GENERIC, visited);
+        REQUIRE(sorted(SearchIndex::find(*root, term)) == sorted(visited));
+      }
+
+      SearchResults visited;
+      root->traverse<Search>("1", NodeType::PARAMETER, visited);
+      REQUIRE(sorted(SearchIndex::find(*root, "1", NodeType::PARAMETER))
+          == sorted(visited));
+    }
+
+    THEN("Prefixes and subtypes are found")
+    {
+      auto found = SearchIndex::find(
+          *root, "bra", NodeType::GENERIC, SearchIndex::Match::PREFIX);
+      REQUIRE(found.size() == 10);
+      REQUIRE(SearchIndex::find(
+                  *root, "ranch", NodeType::GENERIC, SearchIndex::Match::PREFIX)
+                  .empty());
+      REQUIRE(SearchIndex::findSubType(*root, "float").size() == 100);
+    }
+
+    THEN("Queries are limited to the given root")
+    {
+      auto &branch = root->child("branch2");
+      REQUIRE(SearchIndex::find(branch, "leaf").size() == 10);
+      REQUIRE(SearchIndex::find(branch, "branch").size() == 1);
+    }
+
+    WHEN("Nodes are added and removed")
+    {
+      root->child("branch5").createChild("added");
+      root->remove("branch7");
+
+      THEN("The index follows")
+      {
+        REQUIRE(SearchIndex::find(*root, "added").size() == 1);
+        REQUIRE(SearchIndex::find(*root, "branch7").empty());
+        REQUIRE(SearchIndex::find(*root, "leaf").size() == 90);
+        REQUIRE(SearchIndex::size() == 100);
+      }
+    }
+
+    WHEN("A subtree is detached but kept alive")
+    {
+      auto branch = root->child("branch3").shared_from_this();
+      root->remove(*branch);
+
+      THEN("Its nodes leave the index with it")
+      {
+        REQUIRE(SearchIndex::size() == 99);
+        REQUIRE(!SearchIndex::covers(branch->child("leaf0")));
+      }
+
+      THEN("Nodes still linked elsewhere in the tree stay")
+      {
+        root->child("branch4").add(branch->child("leaf0").shared_from_this(),
+            "moved");
+        root->add(branch);
+        root->remove(*branch);
+        REQUIRE(SearchIndex::size() == 100);
+        REQUIRE(SearchIndex::find(*root, "leaf0").size() == 10);
+      }
+    }
+
+    WHEN("A subgraph is built outside of the tree")
+    {
+      auto subgraph = createNode("subgraph");
+      for (int i = 0; i < 10; ++i)
+        subgraph->createChild("imported" + std::to_string(i));
+
+      THEN("It's only indexed once linked into the tree")
+      {
+        REQUIRE(SearchIndex::size() == 110);
+        REQUIRE(!SearchIndex::covers(*subgraph));
+
+        root->add(subgraph);
+        REQUIRE(SearchIndex::size() == 121);
+        REQUIRE(SearchIndex::find(*root, "imported").size() == 10);
+      }
+    }
   }
 }
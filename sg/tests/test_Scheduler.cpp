@@ -0,0 +1,256 @@
+// Copyright 2009 Intel Corporation
+// SPDX-License-Identifier: Apache-2.0
+
+#include "catch/catch.hpp"
+
+#include "sg/Scheduler.h"
+#include "sg/SchedulerTrace.h"
+
+using namespace ospray::sg;
+
+#include <algorithm>
+#include <atomic>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+SCENARIO("sg::Scheduler asynchronous tasks")
+{
+  GIVEN("A scheduler running two tasks at a time")
+  {
+    auto scheduler = Scheduler::create();
+    scheduler->setConcurrency(2);
+    auto instance = scheduler->background();
+
+    THEN("The concurrency is as set")
+    {
+      REQUIRE(scheduler->concurrency() == 2);
+      REQUIRE(scheduler->pool()->numThreads() == 2);
+    }
+
+    WHEN("Many tasks are executed asynchronously")
+    {
+      std::atomic<int> numRun{0};
+      for (int i = 0; i < 1000; ++i)
+        instance->push([&](SchedulerPtr) { numRun++; });
+
+      const auto numStarted = instance->executeAllTasksAsync();
+      instance->wait();
+
+      THEN("All tasks ran once wait() returns")
+      {
+        REQUIRE(numStarted == 1000);
+        REQUIRE(numRun == 1000);
+      }
+
+      THEN("There's nothing left to wait for")
+      {
+        REQUIRE(instance->wait() == 0);
+      }
+    }
+
+    WHEN("A task throws")
+    {
+      instance->push([](SchedulerPtr) { throw std::runtime_error("task"); });
+      instance->executeAllTasksAsync();
+
+      THEN("wait() rethrows the exception once")
+      {
+        REQUIRE_THROWS_AS(instance->wait(), std::runtime_error);
+        REQUIRE_NOTHROW(instance->wait());
+      }
+    }
+
+    WHEN("The concurrency changes after tasks ran")
+    {
+      std::atomic<int> numRun{0};
+      instance->push([&](SchedulerPtr) { numRun++; });
+      instance->executeAllTasksAsync();
+      scheduler->setConcurrency(3);
+      instance->push([&](SchedulerPtr) { numRun++; });
+      instance->executeAllTasksAsync();
+      instance->wait();
+
+      THEN("Tasks of the old and the new pool ran")
+      {
+        REQUIRE(numRun == 2);
+        REQUIRE(scheduler->pool()->numThreads() == 3);
+      }
+    }
+  }
+}
+
+SCENARIO("sg::Scheduler task dependencies, priorities and cancellation")
+{
+  GIVEN("A scheduler")
+  {
+    auto scheduler = Scheduler::create();
+    auto background = scheduler->background();
+    auto ospray = scheduler->ospray();
+    std::vector<std::string> order;
+
+    auto record = [&](const std::string &name) {
+      return [&, name](SchedulerPtr) { order.push_back(name); };
+    };
+
+    WHEN("Tasks of different priorities are pushed")
+    {
+      TaskOptions low;
+      low.priority = -1;
+      TaskOptions high;
+      high.priority = 1;
+
+      background->push("a", record("a"), low);
+      background->push("b", record("b"));
+      background->push("c", record("c"), high);
+      background->push("d", record("d"));
+      background->executeAllTasksSync();
+
+      THEN("They run highest priority first, in push order otherwise")
+      {
+        REQUIRE(order == std::vector<std::string>{"c", "b", "d", "a"});
+      }
+    }
+
+    WHEN("A task depends on tasks of another instance")
+    {
+      auto first = background->push("first", record("first"));
+      auto second = background->push("second", record("second"));
+
+      TaskOptions options;
+      options.dependencies = {first, second};
+      auto attach = ospray->push("attach", record("attach"), options);
+
+      THEN("It's only queued once they finished")
+      {
+        REQUIRE(attach->state() == scheduler::TaskState::WAITING);
+        REQUIRE(ospray->executeAllTasksSync() == 0);
+
+        REQUIRE(background->executeAllTasksSync() == 2);
+        REQUIRE(attach->state() == scheduler::TaskState::QUEUED);
+
+        REQUIRE(ospray->executeAllTasksSync() == 1);
+        REQUIRE(order.back() == "attach");
+        REQUIRE(attach->state() == scheduler::TaskState::FINISHED);
+      }
+    }
+
+    WHEN("A dependency fails")
+    {
+      auto failing = background->push(
+          "failing", [](SchedulerPtr) { throw std::runtime_error("task"); });
+
+      TaskOptions options;
+      options.dependencies = {failing};
+      auto dependent = ospray->push("dependent", record("dependent"), options);
+
+      REQUIRE_THROWS(background->executeAllTasksSync());
+
+      THEN("The dependent task is cancelled")
+      {
+        REQUIRE(failing->state() == scheduler::TaskState::FAILED);
+        REQUIRE(dependent->state() == scheduler::TaskState::CANCELLED);
+        REQUIRE(ospray->executeAllTasksSync() == 0);
+        REQUIRE(order.empty());
+      }
+    }
+
+    WHEN("The token of queued and waiting tasks is cancelled")
+    {
+      TaskOptions options;
+      options.token = CancellationToken::create();
+      auto load = background->push("load", record("load"), options);
+      options.dependencies = {load};
+      auto attach = ospray->push("attach", record("attach"), options);
+      background->push("unrelated", record("unrelated"));
+
+      options.token->cancel();
+
+      THEN("They are skipped, other tasks still run")
+      {
+        REQUIRE(background->executeAllTasksSync() == 1);
+        REQUIRE(ospray->executeAllTasksSync() == 0);
+        REQUIRE(order == std::vector<std::string>{"unrelated"});
+        REQUIRE(load->state() == scheduler::TaskState::CANCELLED);
+        REQUIRE(attach->state() == scheduler::TaskState::CANCELLED);
+      }
+    }
+
+    WHEN("A task is pushed depending on a cancelled one")
+    {
+      auto cancelled = background->push("cancelled", record("cancelled"));
+      cancelled->cancel();
+
+      TaskOptions options;
+      options.dependencies = {cancelled};
+      auto dependent =
+          background->push("dependent", record("dependent"), options);
+
+      THEN("It is cancelled right away")
+      {
+        REQUIRE(dependent->state() == scheduler::TaskState::CANCELLED);
+        REQUIRE(background->executeAllTasksSync() == 0);
+      }
+    }
+  }
+}
+
+SCENARIO("sg::scheduler::Trace")
+{
+  GIVEN("Tasks run while tracing is enabled")
+  {
+    using scheduler::Trace;
+    using scheduler::TraceEventType;
+
+    // the buffer is kept across runs of this scenario
+    static int run = 0;
+    const auto name = "traced" + std::to_string(run++);
+
+    Trace::enable(16);
+    auto scheduler = Scheduler::create();
+    auto background = scheduler->background();
+    for (int i = 0; i < 5; ++i)
+      background->push(name, [](SchedulerPtr) {});
+    background->executeAllTasksAsync();
+    background->wait();
+    Trace::disable();
+
+    auto events = Trace::events();
+
+    THEN("The buffer holds as many events as fit")
+    {
+      REQUIRE(events.size() == 16);
+    }
+
+    THEN("Each task was started and finished")
+    {
+      auto count = [&](TraceEventType type) {
+        return std::count_if(events.begin(), events.end(), [&](const auto &e) {
+          return e.type == type && e.task == name;
+        });
+      };
+      // the oldest events were overwritten
+      REQUIRE(count(TraceEventType::ENQUEUE) <= 5);
+      REQUIRE(count(TraceEventType::START) == 5);
+      REQUIRE(count(TraceEventType::FINISH) == 5);
+      REQUIRE(std::string(events.back().instance) == "background");
+    }
+
+    THEN("Nothing is recorded while disabled")
+    {
+      background->push("untraced", [](SchedulerPtr) {});
+      background->executeAllTasksSync();
+      REQUIRE(Trace::events().back().timestamp == events.back().timestamp);
+    }
+
+    THEN("The export is Chrome trace event JSON")
+    {
+      std::stringstream json;
+      Trace::writeChromeJson(json);
+      REQUIRE(json.str().find("{\"traceEvents\":[") == 0);
+      REQUIRE(json.str().find("\"ph\":\"B\"") != std::string::npos);
+      REQUIRE(json.str().find("\"ph\":\"E\"") != std::string::npos);
+    }
+  }
+}
@@ -11,9 +11,12 @@ namespace sg {
 struct CollectTransferFunctions : public Visitor
 {
   CollectTransferFunctions() = default;
+  CollectTransferFunctions(const CollectTransferFunctions &, ParallelSplit) {}
 
   bool operator()(Node &node, TraversalContext &ctx) override;
 
+  void reduce(CollectTransferFunctions &other);
+
   std::map<std::string, NodePtr> transferFunctions;
 };
 
@@ -32,5 +35,12 @@ inline bool CollectTransferFunctions::operator()(Node &node, TraversalContext &c
   return true;
 }
 
+inline void CollectTransferFunctions::reduce(CollectTransferFunctions &other)
+{
+  // later entries win, as in a sequential traversal
+  for (auto &tfn : other.transferFunctions)
+    transferFunctions[tfn.first] = tfn.second;
+}
+
 }  // namespace sg
 } // namespace ospray
@@ -24,6 +24,8 @@ namespace ospray {
   {
     if (node.subtreeModifiedButNotCommitted()) {
       node.preCommit();
+      // every modified child is visited below, nothing is left queued
+      node.takeDirtyChildren();
       return true;
     } else {
       return false;
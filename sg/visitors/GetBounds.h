@@ -11,14 +11,19 @@ namespace ospray {
   struct GetBounds : public Visitor
   {
     GetBounds() = default;
+    GetBounds(const GetBounds &, ParallelSplit);
 
     bool operator()(Node &node, TraversalContext &ctx) override;
 
+    void reduce(GetBounds &other);
+
     box3f bounds;
   };
 
   // Inlined definitions //////////////////////////////////////////////////////
 
+  inline GetBounds::GetBounds(const GetBounds &, ParallelSplit) {}
+
   inline bool GetBounds::operator()(Node &node, TraversalContext &)
   {
     switch (node.type()) {
@@ -37,5 +42,10 @@ namespace ospray {
     }
   }
 
+  inline void GetBounds::reduce(GetBounds &other)
+  {
+    bounds.extend(other.bounds);
+  }
+
   }  // namespace sg
 } // namespace ospray
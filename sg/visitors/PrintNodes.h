@@ -4,6 +4,9 @@
 #pragma once
 
 #include "../Node.h"
+// stl
+#include <iostream>
+#include <sstream>
 
 namespace ospray {
   namespace sg {
@@ -11,15 +14,32 @@ namespace ospray {
   struct PrintNodes : public Visitor
   {
     PrintNodes() = default;
+    PrintNodes(const PrintNodes &, ParallelSplit);
 
     bool operator()(Node &node, TraversalContext &ctx) override;
+
+    void reduce(PrintNodes &other);
+
+   private:
+    // task-local output during a parallel traversal, printed in order
+    std::ostringstream buffer;
+    std::ostream &out{std::cout};
   };
 
   // Inlined definitions //////////////////////////////////////////////////////
 
+  inline PrintNodes::PrintNodes(const PrintNodes &, ParallelSplit) : out(buffer)
+  {
+  }
+
+  inline void PrintNodes::reduce(PrintNodes &other)
+  {
+    out << other.buffer.str();
+  }
+
 #define PRINT_AS(node, type) \
   if (node.subType() == #type) \
-  std::cout << " [" << node.valueAs<type>() << "]";
+  out << " [" << node.valueAs<type>() << "]";
 
   // uchar/uint8_t is only useful printed as an int
   static std::ostream &operator<<(std::ostream &cout, const uint8_t &uc)
@@ -37,7 +57,7 @@ namespace ospray {
 
   inline bool PrintNodes::operator()(Node &node, TraversalContext &ctx)
   {
-    std::cout << std::string(2 * ctx.level, ' ') << node.name() << " : "
+    out << std::string(2 * ctx.level, ' ') << node.name() << " : "
               << node.subType() << " : " << NodeTypeToString[node.type()];
 
     // A couple of usings to make subType strings match types
@@ -65,8 +85,8 @@ namespace ospray {
     PRINT_AS(node, transform); 
     PRINT_AS(node, filename); 
     if (node.subType() == "Data")
-      std::cout << " [" << node.nodeAs<Data>() << "]";
-    std::cout << std::endl;
+      out << " [" << node.nodeAs<Data>() << "]";
+    out << std::endl;
 
     // XXX Debug only, probably need something better here.
     // Don't litter the PrintNodes with copies of instances, only fully traverse
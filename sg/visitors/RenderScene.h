@@ -8,6 +8,7 @@
 #include "sg/Util.h"
 #include "sg/camera/Camera.h"
 #include "sg/renderer/MaterialRegistry.h"
+#include "sg/scene/InstanceArray.h"
 #include "sg/scene/Transform.h"
 #include "sg/scene/World.h"
 #include "sg/scene/geometry/Geometry.h"
@@ -16,10 +17,15 @@
 
 // std
 #include <stack>
+#include <unordered_map>
 
 namespace ospray {
   namespace sg {
 
+  // Builds the OSPRay instances of a world. A RenderScene kept across commits
+  // (as World does) only rebuilds the transforms whose subtree or accumulated
+  // transform changed since its last traversal, the instances of all other
+  // transforms are taken from the previous traversal.
   struct RenderScene : public Visitor
   {
     RenderScene();
@@ -31,10 +37,19 @@ namespace ospray {
    private:
     // Helper Functions //
     void createGeometry(Node &node);
+    void commitSkinnedGeometry(Geometry &geomNode);
     void createVolume(Node &node);
     void createInstanceFromGroup(Node &node);
+    void createLightGroupInstance(Node &node);
+    void placeInstance(InstanceArray::Slot slot);
     void placeInstancesInWorld();
 
+    bool modifiedSinceRendered(const Node &node) const;
+    static uint64_t pathThrough(uint64_t path, const Node &node);
+    bool reuseCachedSubtree(Node &node);
+    void cacheSubtree(Node &node);
+    void pruneCaches();
+
     unsigned int getInstId()
     {
       static unsigned int inst_counter = 1;
@@ -62,7 +77,10 @@ namespace ospray {
     bool setTextureVolume{false};
     cpp::World world;
     std::vector<box3f> worldRegions;
-    std::vector<cpp::Instance> instances;
+    // the world's instances, in stable slots
+    InstanceArray *instances{nullptr};
+    // instances used by this traversal, in traversal order
+    std::vector<InstanceArray::Ref> instanceRefs;
 
     // unique OSPRay object groups to avoid regenartion of groups
     std::unordered_map<void *, cpp::Group> groups;
@@ -70,13 +88,102 @@ namespace ospray {
     std::stack<affine3f> xfms;
     std::stack<affine3f> endXfms;
     std::stack<bool> xfmsDiverged;
+    // hash of the transforms above, a subtree reached through several
+    // parents is instantiated once for each path
+    std::stack<uint64_t> paths;
     std::stack<uint32_t> materialIDs;
     std::stack<cpp::TransferFunction> tfns;
-    std::shared_ptr<OSPInstanceSGIdMap> instSGIdMap{nullptr};
-    std::shared_ptr<OSPGeomModelSGIdMap> geomSGIdMap{nullptr};
+    SGIdTable *instanceNodes{nullptr};
+    SGIdTable *geometryNodes{nullptr};
     Node *instRoot{nullptr};
-    unsigned int sgGeomId;
-    unsigned int sgInstId;
+    unsigned int sgGeomId{0};
+    unsigned int sgInstId{0};
+
+    // Incremental updates //
+
+    // What a transform's subtree inherits from above
+    struct SubtreeContext
+    {
+      affine3f xfm;
+      affine3f endXfm;
+      bool motionBlur;
+      unsigned int sgInstId;
+      unsigned int sgGeomId;
+      OSPTransferFunction tfn;
+
+      bool operator==(const SubtreeContext &o) const
+      {
+        return xfm == o.xfm && endXfm == o.endXfm && motionBlur == o.motionBlur
+            && sgInstId == o.sgInstId && sgGeomId == o.sgGeomId
+            && tfn == o.tfn;
+      }
+    };
+
+    SubtreeContext currentContext() const;
+
+    // Everything a transform's subtree added to the world, as of the last
+    // traversal which visited it
+    struct CachedSubtree
+    {
+      SubtreeContext context;
+      std::vector<InstanceArray::Ref> instances;
+      std::vector<box3f> regions;
+      // skinned geometry depends on joints elsewhere in the tree
+      bool reusable{true};
+      size_t generation{0};
+    };
+
+    struct SubtreeStart
+    {
+      SubtreeContext context;
+      size_t instances;
+      size_t regions;
+      size_t skinned;
+    };
+
+    // A transform as reached along a path
+    struct Occurrence
+    {
+      Node *node;
+      uint64_t path;
+
+      bool operator==(const Occurrence &o) const
+      {
+        return node == o.node && path == o.path;
+      }
+    };
+
+    struct OccurrenceHash
+    {
+      size_t operator()(const Occurrence &o) const
+      {
+        return size_t(pathThrough(o.path, *o.node));
+      }
+    };
+
+    std::unordered_map<Occurrence, CachedSubtree, OccurrenceHash> subtreeCache;
+
+    struct CachedVolumeGroup
+    {
+      std::weak_ptr<Node> volume;
+      cpp::Group group{nullptr};
+      OSPTransferFunction tfn{nullptr};
+    };
+
+    std::unordered_map<Node *, CachedVolumeGroup> volumeGroups;
+    std::stack<SubtreeStart> subtreeStarts;
+    // a transfer function above was modified
+    std::stack<bool> contextChanged;
+    // in-group lights of each transform being traversed
+    std::stack<std::vector<cpp::Light>> groupLights;
+    Node *skippedNode{nullptr};
+    size_t numSkinned{0};
+    size_t numCached{0};
+    size_t generation{0};
+    bool fullRebuild{true};
+    TimeStamp lastRendered;
+    // identifies the traversal, for the skin palettes
+    TimeStamp traversalStamp;
   };
 
   // Inlined definitions //////////////////////////////////////////////////////
@@ -86,6 +193,9 @@ namespace ospray {
     xfms.emplace(math::one);
     endXfms.emplace(math::one);
     xfmsDiverged.emplace(false);
+    paths.emplace(0);
+    contextChanged.emplace(true);
+    groupLights.emplace();
   }
 
   inline RenderScene::~RenderScene()
@@ -101,10 +211,24 @@ namespace ospray {
     case NodeType::WORLD: {
       world = node.valueAs<cpp::World>();
       auto worldNode = node.nodeAs<World>();
-      instSGIdMap = worldNode->instSGIdMap;
-      instSGIdMap->clear();
-      geomSGIdMap = worldNode->geomSGIdMap;
-      geomSGIdMap->clear();
+      instanceNodes = &worldNode->instanceNodes;
+      geometryNodes = &worldNode->geometryNodes;
+
+      // Instances are kept by the world, those not used by this traversal
+      // (mostly taken from cached subtrees) are released at the end
+      instances = &worldNode->instances;
+      instanceRefs.clear();
+      worldRegions.clear();
+      groups.clear();
+      current.textures.clear();
+      materialIDs = std::stack<uint32_t>();
+      contextChanged = std::stack<bool>();
+      contextChanged.push(fullRebuild);
+      groupLights = std::stack<std::vector<cpp::Light>>();
+      groupLights.emplace();
+      generation++;
+      numCached = 0;
+      traversalStamp.renew();
     } break;
     case NodeType::MATERIAL_REFERENCE:
       materialIDs.push(node.valueAs<int>());
@@ -119,44 +243,29 @@ namespace ospray {
       break;
     case NodeType::TRANSFER_FUNCTION:
       tfns.push(node.valueAs<cpp::TransferFunction>());
+      // volumes below without their own transfer function use this one
+      contextChanged.push(contextChanged.top() || modifiedSinceRendered(node));
       break;
     case NodeType::TRANSFORM: {
-      affine3f xfm =
-          affine3f::rotate(node.child("rotation").valueAs<quaternionf>());
-      affine3f endXfm = xfm;
-      bool diverged = false;
-      if (node.child("rotation").hasChild("endKey")) {
-        diverged = true;
-        endXfm = affine3f::rotate(
-            node.child("rotation").child("endKey").valueAs<quaternionf>());
-      }
+      if (reuseCachedSubtree(node))
+        return false;
+      subtreeStarts.push({currentContext(),
+          instanceRefs.size(),
+          worldRegions.size(),
+          numSkinned});
+      groupLights.emplace();
+
+      // no shared_ptr copy on this path, it runs for every transform
+      auto *xfmNode = static_cast<Transform *>(&node);
+      xfmNode->updateLocalXfm();
 
-      const affine3f sxfm =
-          affine3f::scale(node.child("scale").valueAs<vec3f>());
-      xfm *= sxfm;
-      if (node.child("scale").hasChild("endKey")) {
-        diverged = true;
-        endXfm *= affine3f::scale(
-            node.child("scale").child("endKey").valueAs<vec3f>());
-      } else
-        endXfm *= sxfm;
-
-      xfm.p = node.child("translation").valueAs<vec3f>();
-      if (node.child("translation").hasChild("endKey")) {
-        diverged = true;
-        endXfm.p = node.child("translation").child("endKey").valueAs<vec3f>();
-      } else
-        endXfm.p = xfm.p;
-
-      auto xfmNode = node.nodeAs<Transform>();
-      xfmNode->localXfm = xfm * node.valueAs<affine3f>();
       xfmNode->accumulatedXfm = xfms.top() * xfmNode->localXfm;
       xfms.push(xfmNode->accumulatedXfm);
-      xfmNode->localEndXfm = endXfm * node.valueAs<affine3f>();
       xfmNode->accumulatedEndXfm = endXfms.top() * xfmNode->localEndXfm;
       endXfms.push(xfmNode->accumulatedEndXfm);
-      xfmNode->motionBlur = xfmsDiverged.top() || diverged;
+      xfmNode->motionBlur = xfmsDiverged.top() || xfmNode->localMotionBlur;
       xfmsDiverged.push(xfmNode->motionBlur);
+      paths.push(pathThrough(paths.top(), node));
 
       if (!instRoot && node.hasChild("instanceId")) {
         instRoot = &node;
@@ -168,6 +277,8 @@ namespace ospray {
           node.child("sgInstId").setSGNoUI();
         } else if (node.hasChild("sgInstId"))
           sgInstId = node.child("sgInstId").valueAs<unsigned int>();
+        if (instanceNodes)
+          instanceNodes->set(sgInstId, node);
       }
 
       if (node.hasChild("geomId") && !node.hasChild("sgGeomId")) {
@@ -177,6 +288,8 @@ namespace ospray {
         node.child("sgGeomId").setSGNoUI();
       } else if (node.hasChild("sgGeomId"))
         sgGeomId = node.child("sgGeomId").valueAs<unsigned int>();
+      if (geometryNodes && node.hasChild("sgGeomId"))
+        geometryNodes->set(sgGeomId, node);
 
       // Allow hiding entire branches of the hierarchy
       // If transform is hidden, stop traversing children
@@ -215,8 +328,16 @@ namespace ospray {
 
   inline void RenderScene::postChildren(Node &node, TraversalContext &)
   {
+    // A reused subtree was not entered
+    if (&node == skippedNode) {
+      skippedNode = nullptr;
+      return;
+    }
+
     switch (node.type()) {
     case NodeType::WORLD:
+      // in-group lights outside of any transform
+      createLightGroupInstance(node);
       placeInstancesInWorld();
       if (sgUsingMpi()) {
         if (worldRegions.size()) {
@@ -224,9 +345,14 @@ namespace ospray {
         }
       }
       world.commit();
+      pruneCaches();
+      fullRebuild = false;
+      // Modifications made by this traversal (eg. sgInstId) are older
+      lastRendered.renew();
       break;
     case NodeType::TRANSFER_FUNCTION:
       tfns.pop();
+      contextChanged.pop();
       break;
     case NodeType::GEOMETRY:
       createGeometry(node);
@@ -235,29 +361,19 @@ namespace ospray {
       if (!node.child("enable").valueAs<bool>())
         break;
       // Only lights marked as "inGroup" belong in a group lights list, others
-      // have been put on the world list.
-      if (node.nodeAs<Light>()->inGroup) {
-        auto &light = node.valueAs<cpp::Light>();
-        cpp::Group group;
-        group.setParam("light", cpp::CopiedData(light));
-        group.commit();
-        cpp::Instance inst(group);
-        if (xfmsDiverged.top()) { // motion blur
-          std::vector<affine3f> motionXfms;
-          motionXfms.push_back(xfms.top());
-          motionXfms.push_back(endXfms.top());
-          inst.setParam("motion.transform", cpp::CopiedData(motionXfms));
-        } else
-          inst.setParam("transform", xfms.top());
-        inst.commit();
-        instances.push_back(inst);
-      }
+      // have been put on the world list. All of a transform's lights share
+      // one group.
+      if (node.nodeAs<Light>()->inGroup)
+        groupLights.top().push_back(node.valueAs<cpp::Light>());
     } break;
     case NodeType::TRANSFORM:
       createInstanceFromGroup(node);
+      createLightGroupInstance(node);
       xfms.pop();
       endXfms.pop();
       xfmsDiverged.pop();
+      paths.pop();
+      cacheSubtree(node);
       if (&node == instRoot)
         instRoot = nullptr;
       if (node.hasChild("sgInstId"))
@@ -282,80 +398,10 @@ namespace ospray {
 
     // skinning
     if (geomNode->skin) {
-      auto &joints = geomNode->skin->joints;
-      auto &inverseBindMatrices = geomNode->skin->inverseBindMatrices;
-      const size_t weightsPerVertex = geomNode->weightsPerVertex;
-      geomNode->skinnedEndPositions.resize(geomNode->skinnedPositions.size());
-      geomNode->skinnedEndNormals.resize(geomNode->skinnedNormals.size());
-      size_t weightIdx = 0;
-
-      // only worth with huge meshes:
-      // tasking::parallel_in_blocks_of<64>(geomNode->positions.size(),
-      // [&](size_t start, size_t end)
-      for (size_t i = 0; i < geomNode->positions.size(); ++i) {
-        affine3f xfm{zero};
-        affine3f endXfm{zero};
-        for (size_t j = 0; j < weightsPerVertex; ++j, ++weightIdx) {
-          const int idx = geomNode->joints[weightIdx];
-          // skinning matrix
-          xfm = xfm
-              + geomNode->weights[weightIdx]
-                  * joints[idx]->nodeAs<Transform>()->accumulatedXfm
-                  * inverseBindMatrices[idx];
-          endXfm = endXfm
-              + geomNode->weights[weightIdx]
-                  * joints[idx]->nodeAs<Transform>()->accumulatedEndXfm
-                  * inverseBindMatrices[idx];
-        }
-        // from gltf docu:
-        // final joint matrix = globalTransformOfNodeThatTheMeshIsAttachedTo^-1 * 
-        //                         globalTransformOfJointNode(j) *
-        //                         inverseBindMatrixForJoint(j)
-        xfm = rcp(geomNode->skeletonRoot->nodeAs<Transform>()->accumulatedXfm)
-            * xfm;
-        endXfm =
-            rcp(geomNode->skeletonRoot->nodeAs<Transform>()->accumulatedEndXfm)
-            * endXfm;
-        geomNode->skinnedPositions[i] = xfmPoint(xfm, geomNode->positions[i]);
-        geomNode->skinnedEndPositions[i] =
-            xfmPoint(endXfm, geomNode->positions[i]);
-        if (geomNode->skinnedNormals.size()) {
-          geomNode->skinnedNormals[i] = xfmNormal(xfm, geomNode->normals[i]);
-          geomNode->skinnedEndNormals[i] =
-              xfmNormal(endXfm, geomNode->normals[i]);
-        }
-      }
-
-      bool motionBlur = geomNode->skeletonRoot->nodeAs<Transform>()->motionBlur;
-      for (auto idx : geomNode->joints)
-        motionBlur |= joints[idx]->nodeAs<Transform>()->motionBlur;
-
-      auto &geom = geomNode->valueAs<cpp::Geometry>();
-      if (motionBlur) {
-        std::vector<cpp::SharedData> motionPos;
-        motionPos.push_back(cpp::SharedData(geomNode->skinnedPositions));
-        motionPos.push_back(cpp::SharedData(geomNode->skinnedEndPositions));
-        geom.setParam("motion.vertex.position", cpp::CopiedData(motionPos));
-        geom.removeParam("vertex.position");
-        if (geomNode->skinnedNormals.size()) {
-          std::vector<cpp::SharedData> motionNor;
-          motionNor.push_back(cpp::SharedData(geomNode->skinnedNormals));
-          motionNor.push_back(cpp::SharedData(geomNode->skinnedEndNormals));
-          geom.setParam("motion.vertex.normal", cpp::CopiedData(motionNor));
-          geom.removeParam("vertex.normal");
-        }
-      } else {
-        geom.setParam("vertex.position", cpp::SharedData(geomNode->skinnedPositions));
-        geom.removeParam("motion.vertex.position");
-        if (geomNode->skinnedNormals.size()) {
-          geom.setParam("vertex.normal", cpp::SharedData(geomNode->skinnedNormals));
-          geom.removeParam("motion.vertex.normal");
-        }
-      }
-      geom.commit();
-
-      // Recommit the cpp::Group for skinned animation to take effect
-      geomNode->group->commit();
+      numSkinned++;
+      // nothing to upload if no joint moved
+      if (geomNode->updateSkinning(traversalStamp))
+        commitSkinnedGeometry(*geomNode);
     }
 
     if (sgUsingMpi()) {
@@ -364,15 +410,54 @@ namespace ospray {
         worldRegions.push_back(mpiRegion);
       }
     }
+    // The model writes the sgGeomId to the object ID buffer. There's one
+    // model per geometry, a geometry shared by transforms with different
+    // sgGeomIds keeps the first one for as long as its transform exists,
+    // rather than being re-committed whenever another transform is visited.
+    const bool ownedId = geomNode->sgGeomId && geometryNodes
+        && geometryNodes->get(geomNode->sgGeomId);
+    if (sgGeomId && geomNode->sgGeomId != sgGeomId && !ownedId) {
+      geomNode->sgGeomId = sgGeomId;
+      geomNode->model->setParam("id", sgGeomId);
+      geomNode->model->commit();
+      if (geomNode->group)
+        geomNode->group->commit();
+    }
+
     // update handle
     geomHandle = reinterpret_cast<void *>(node.valueAs<cpp::Geometry>().handle());
     if (geomNode->group)
       groups.emplace(std::make_pair(geomHandle, *geomNode->group));
+  }
+
+  inline void RenderScene::commitSkinnedGeometry(Geometry &geomNode)
+  {
+    auto &geom = geomNode.valueAs<cpp::Geometry>();
+    if (geomNode.skinnedMotionBlur) {
+      std::vector<cpp::SharedData> motionPos;
+      motionPos.push_back(cpp::SharedData(geomNode.skinnedPositions));
+      motionPos.push_back(cpp::SharedData(geomNode.skinnedEndPositions));
+      geom.setParam("motion.vertex.position", cpp::CopiedData(motionPos));
+      geom.removeParam("vertex.position");
+      if (geomNode.skinnedNormals.size()) {
+        std::vector<cpp::SharedData> motionNor;
+        motionNor.push_back(cpp::SharedData(geomNode.skinnedNormals));
+        motionNor.push_back(cpp::SharedData(geomNode.skinnedEndNormals));
+        geom.setParam("motion.vertex.normal", cpp::CopiedData(motionNor));
+        geom.removeParam("vertex.normal");
+      }
+    } else {
+      geom.setParam("vertex.position", cpp::SharedData(geomNode.skinnedPositions));
+      geom.removeParam("motion.vertex.position");
+      if (geomNode.skinnedNormals.size()) {
+        geom.setParam("vertex.normal", cpp::SharedData(geomNode.skinnedNormals));
+        geom.removeParam("motion.vertex.normal");
+      }
+    }
+    geom.commit();
 
-    auto ospGeometricModel = geomNode->model->handle();
-    if (geomSGIdMap && sgGeomId)
-      geomSGIdMap->emplace(OSPGeomModelSGIdMap::value_type(
-          std::make_pair(ospGeometricModel, sgGeomId)));
+    // Recommit the cpp::Group for skinned animation to take effect
+    geomNode.group->commit();
   }
 
   inline void RenderScene::createVolume(Node &node)
@@ -388,12 +473,28 @@ namespace ospray {
     if (groups.find(volHandle) != groups.end())
       return;
 
+    if (sgUsingMpi()) {
+      if (node.hasChild("mpiRegion")) {
+        box3f mpiRegion = node.child("mpiRegion").valueAs<box3f>();
+        worldRegions.push_back(mpiRegion);
+      }
+    }
+
+    cpp::TransferFunction tfn =
+        node.hasChildOfType(sg::NodeType::TRANSFER_FUNCTION)
+        ? node["transferFunction"].valueAs<cpp::TransferFunction>()
+        : tfns.top();
+
+    // An unchanged volume keeps its group, and so its instances
+    auto &cached = volumeGroups[&node];
+    if (cached.group.handle() && cached.tfn == tfn.handle()
+        && !contextChanged.top() && !modifiedSinceRendered(node)) {
+      groups.emplace(std::make_pair(volHandle, cached.group));
+      return;
+    }
+
     cpp::VolumetricModel model(vol);
-    if (node.hasChildOfType(sg::NodeType::TRANSFER_FUNCTION)) {
-      model.setParam("transferFunction",
-                     node["transferFunction"].valueAs<cpp::TransferFunction>());
-    } else
-      model.setParam("transferFunction", tfns.top());
+    model.setParam("transferFunction", tfn);
     if (node.hasChild("densityScale"))
       model.setParam("densityScale", node["densityScale"].valueAs<float>());
     if (node.hasChild("anisotropy"))
@@ -412,16 +513,12 @@ namespace ospray {
 
     cpp::Group group;
     group.setParam("volume", cpp::CopiedData(model));
-
-    if (sgUsingMpi()) {
-      if (node.hasChild("mpiRegion")) {
-        box3f mpiRegion = node.child("mpiRegion").valueAs<box3f>();
-        worldRegions.push_back(mpiRegion);
-      }
-    }
-
     group.commit();
 
+    cached.volume = node.shared_from_this();
+    cached.group = group;
+    cached.tfn = tfn.handle();
+
     // update handle
     volHandle = reinterpret_cast<void *>(node.valueAs<cpp::Volume>().handle());
     groups.emplace(std::make_pair(volHandle, group));
@@ -429,29 +526,25 @@ namespace ospray {
 
   inline void RenderScene::createInstanceFromGroup(Node &node)
   {
-    auto setInstance = [&](auto group) {
+    auto setInstance = [&](cpp::Group &group) {
       group.setParam(
           "dynamicScene", node.child("dynamicScene").valueAs<bool>());
       group.setParam("compactMode", node.child("compactMode").valueAs<bool>());
       group.setParam("robustMode", node.child("robustMode").valueAs<bool>());
 
-      cpp::Instance inst(group);
-      if (xfmsDiverged.top()) { // motion blur
-        std::vector<affine3f> motionXfms;
-        motionXfms.push_back(xfms.top());
-        motionXfms.push_back(endXfms.top());
-        inst.setParam("motion.transform", cpp::CopiedData(motionXfms));
-      } else
-        inst.setParam("transform", xfms.top());
-      inst.commit();
-      instances.push_back(inst);
-
-      // sg picking
-      if (instSGIdMap && sgInstId) {
-        auto ospInstance = inst.handle();
-        instSGIdMap->emplace(OSPInstanceSGIdMap::value_type(
-            std::make_pair(ospInstance, sgInstId)));
-      }
+      if (!instances)
+        return;
+
+      // The instance of this group by this transform (as reached along the
+      // path above it) is updated in place
+      InstanceArray::Key key{&node, group.handle(), paths.top()};
+      InstanceArray::Slot slot;
+      if (!instances->find(key, traversalStamp, slot))
+        slot = instances->insert(key, group, traversalStamp);
+      // sg picking, committed with the transform
+      instances->setId(slot, sgInstId);
+      placeInstance(slot);
+      instanceRefs.push_back(instances->ref(slot));
     };
 
     if (node.hasChildOfType(NodeType::GEOMETRY)) {
@@ -495,16 +588,143 @@ namespace ospray {
     }
 
 #if defined(DEBUG)
-      std::cout << "number of instances : " << instances.size() << std::endl;
+      std::cout << "number of instances : " << instanceRefs.size() << std::endl;
 #endif
     }
 
-  inline void RenderScene::placeInstancesInWorld()
+  inline void RenderScene::createLightGroupInstance(Node &node)
   {
-    if (!instances.empty())
-      world.setParam("instance", cpp::CopiedData(instances));
+    auto lights = std::move(groupLights.top());
+    groupLights.pop();
+
+    if (lights.empty() || !instances)
+      return;
+
+    // One group and instance holds all in-group lights of a transform. The
+    // transform itself is the key, it can't be mistaken for a group handle.
+    InstanceArray::Key key{&node, &node, paths.top()};
+    InstanceArray::Slot slot;
+    if (!instances->find(key, traversalStamp, slot))
+      slot = instances->insert(key, cpp::Group(), traversalStamp);
+
+    auto &group = instances->group(slot);
+    group.setParam("light", cpp::CopiedData(lights));
+    group.commit();
+
+    placeInstance(slot);
+    instanceRefs.push_back(instances->ref(slot));
+  }
+
+  inline void RenderScene::placeInstance(InstanceArray::Slot slot)
+  {
+    if (xfmsDiverged.top()) // motion blur
+      instances->setTransform(slot, xfms.top(), endXfms.top());
     else
-      world.removeParam("instance");
+      instances->setTransform(slot, xfms.top());
+  }
+
+  inline void RenderScene::placeInstancesInWorld()
+  {
+    // The world's instance list only changes when instances were added or
+    // released, moved instances were updated in place
+    instances->releaseUnused(traversalStamp);
+    instances->placeInWorld(world);
+  }
+
+  inline bool RenderScene::modifiedSinceRendered(const Node &node) const
+  {
+    return fullRebuild || node.whenCreated() > lastRendered
+        || node.lastModified() > lastRendered
+        || node.childrenLastModified() > lastRendered;
+  }
+
+  inline uint64_t RenderScene::pathThrough(uint64_t path, const Node &node)
+  {
+    const uint64_t n = uint64_t(reinterpret_cast<uintptr_t>(&node));
+    return path ^ (n + 0x9e3779b97f4a7c15ull + (path << 6) + (path >> 2));
+  }
+
+  inline RenderScene::SubtreeContext RenderScene::currentContext() const
+  {
+    return {xfms.top(),
+        endXfms.top(),
+        xfmsDiverged.top(),
+        sgInstId,
+        sgGeomId,
+        tfns.empty() ? nullptr : tfns.top().handle()};
+  }
+
+  inline bool RenderScene::reuseCachedSubtree(Node &node)
+  {
+    if (contextChanged.top() || modifiedSinceRendered(node))
+      return false;
+
+    // Subtrees moved to another parent, or below a moved transform, are
+    // rebuilt as well
+    auto itr = subtreeCache.find({&node, paths.top()});
+    if (itr == subtreeCache.end() || !itr->second.reusable
+        || !(itr->second.context == currentContext()))
+      return false;
+
+    // Instances of a subtree which was out of the world were released, those
+    // already used by another visit along the same path are rebuilt
+    auto &cached = itr->second;
+    for (auto &ref : cached.instances)
+      if (!instances || !instances->available(ref, traversalStamp))
+        return false;
+    for (auto &ref : cached.instances)
+      instances->touch(ref, traversalStamp);
+
+    instanceRefs.insert(
+        instanceRefs.end(), cached.instances.begin(), cached.instances.end());
+    worldRegions.insert(
+        worldRegions.end(), cached.regions.begin(), cached.regions.end());
+
+    cached.generation = generation;
+    numCached++;
+    skippedNode = &node;
+    return true;
+  }
+
+  inline void RenderScene::cacheSubtree(Node &node)
+  {
+    auto start = subtreeStarts.top();
+    subtreeStarts.pop();
+
+    // the path above the transform, its own was popped already
+    auto &cached = subtreeCache[{&node, paths.top()}];
+    cached.context = start.context;
+    cached.instances.assign(
+        instanceRefs.begin() + start.instances, instanceRefs.end());
+    cached.regions.assign(worldRegions.begin() + start.regions, worldRegions.end());
+    cached.reusable = numSkinned == start.skinned;
+    cached.generation = generation;
+    numCached++;
+  }
+
+  inline void RenderScene::pruneCaches()
+  {
+    // Entries of subtrees removed from the world are swept once the cache
+    // holds mostly unused entries. Entries nested in reused subtrees are
+    // swept too and rebuilt if needed.
+    if (subtreeCache.size() > 2 * numCached + 64) {
+      for (auto itr = subtreeCache.begin(); itr != subtreeCache.end();) {
+        if (itr->second.generation != generation)
+          itr = subtreeCache.erase(itr);
+        else
+          ++itr;
+      }
+    }
+
+    // Volumes are few, the groups (and models) of volumes removed from the
+    // scene are released right away
+    for (auto itr = volumeGroups.begin(); itr != volumeGroups.end();) {
+      auto volume = itr->second.volume.lock();
+      if (!volume || !volume->hasParents())
+        itr = volumeGroups.erase(itr);
+      else
+        ++itr;
+    }
   }
 
   }  // namespace sg
@@ -15,12 +15,17 @@ namespace ospray {
     struct Search : public Visitor
     {
       Search(const std::string &s, const NodeType nt, SearchResults &v);
+      Search(const Search &parent, ParallelSplit);
 
       bool operator()(Node &node, TraversalContext &ctx) override;
 
+      void reduce(Search &other);
+
      private:
       NodeType type;
       std::string term;
+      // task-local hits during a parallel traversal
+      SearchResults localResults;
       SearchResults &results;
     };
 
@@ -32,6 +37,11 @@ namespace ospray {
     {
     }
 
+    inline Search::Search(const Search &parent, ParallelSplit)
+        : type(parent.type), term(parent.term), results(localResults)
+    {
+    }
+
     inline bool Search::operator()(Node &node, TraversalContext &)
     {
       if (type == NodeType::GENERIC || node.type() == type)
@@ -41,5 +51,12 @@ namespace ospray {
         }
       return true;
     }
+
+    inline void Search::reduce(Search &other)
+    {
+      results.insert(results.end(),
+          other.results.begin(),
+          other.results.end());
+    }
   }  // namespace sg
 }  // namespace ospray